@@ -0,0 +1,234 @@
+/*
+ * Kernel benchmark target, built instead of main.c and OS_Cfg.c with:
+ *   OS_BENCHMARK=1, OS_PRIVILEGED_TASKS=1 (tasks read DWT->CYCCNT), TasksNo >= 4 + OS_SOFTWARE_TIMERS + OS_BENCH_MAX_DUMMIES
+ * Host example:
+ *   gcc -DOS_PORT_POSIX -DOS_BENCHMARK=1 -DTasksNo=69 -IIncludes Bench/OS_Bench_Main.c Source/OS.c \
+ *       Source/OS_Port_Posix.c Source/OS_Bench.c -o os_bench
+ *
+ * Reports, over UART0 (target) or stdout (host):
+ *   - activate-to-run latency: OS_ActivateTask of a higher-priority task until it runs
+ *   - give-to-wake latency:   SemaphoreGive until the waiting higher-priority task runs
+ *   - notify-to-wake latency: OS_TaskNotify until the waiting higher-priority task runs
+ *   - SVC_Handler cost
+ *   - SysTick_Handler cost for a growing number of periodic tasks
+ *   - application IRQ latency (Timer 0A / host timer signal) while the kernel runs
+ *   - stack high-water mark and suggested StackSize of every task
+ *   - CPU load, switches and preemptions of every task over the last window
+ */
+
+#include "Schedular.h"
+#include "OS_Bench.h"
+
+#if defined(OS_PORT_POSIX)
+#include <stdlib.h>
+#endif
+
+#define OS_BENCH_SAMPLES          1000U
+#define OS_BENCH_TASK_STEP        16U
+#define OS_BENCH_MAX_DUMMIES      (TasksNo - 4U - OS_SOFTWARE_TIMERS)
+#define OS_BENCH_WINDOW_TICKS     1000U
+
+void Bench_Control(void);
+void Bench_Waker(void);
+void Bench_Sleeper(void);
+void Bench_Dummy(void);
+
+Task_ref Bench_ControlTask = {
+  .StackSize = 512,
+  .Priority = 1,
+  .p_TaskEntry = Bench_Control,
+  .TimingWaiting.Blocking = BlockingEnabled,
+  .TimingWaiting.Ticks_Count = OS_BENCH_WINDOW_TICKS,
+  .TaskName = "BenchControl"
+};
+
+Task_ref Bench_SleeperTask = {
+  .StackSize = 512,
+  .Priority = 2,
+  .p_TaskEntry = Bench_Sleeper,
+  .TimingWaiting.Blocking = BlockingDisabled,
+  .TaskName = "BenchSleeper"
+};
+
+Task_ref Bench_WakerTask = {
+  .StackSize = 512,
+  .Priority = 3,
+  .p_TaskEntry = Bench_Waker,
+  .TimingWaiting.Blocking = BlockingDisabled,
+  .TaskName = "BenchWaker"
+};
+
+Task_ref Bench_Dummies[OS_BENCH_MAX_DUMMIES];
+
+BinarySemaphore Bench_Semaphore = {NULL_PTR, NULL_PTR, "BenchSemaphore"};
+
+OS_BenchStat Bench_ActivateStat = {.Name = "activate-to-run"};
+OS_BenchStat Bench_GiveStat     = {.Name = "give-to-wake"};
+OS_BenchStat Bench_NotifyStat   = {.Name = "notify-to-wake"};
+
+/* What the sleeper waits on, and the stat its wakeups go to */
+#define BENCH_PHASE_ACTIVATE      0U
+#define BENCH_PHASE_SEMAPHORE     1U
+#define BENCH_PHASE_NOTIFY        2U
+
+static OS_BenchStat* const Bench_PhaseStat[] = {&Bench_ActivateStat, &Bench_GiveStat, &Bench_NotifyStat};
+
+static volatile uint32 Bench_T0;
+static volatile uint8  Bench_Phase;
+static uint32          Bench_DummiesNo;
+
+
+/* Higher-priority side of the latency tests: runs as soon as the waker activates or signals it */
+void Bench_Sleeper(void){
+  
+  uint32 now;
+  
+  while(1){
+    now = OS_PORT_CYCLES();
+    if(Bench_T0 != 0){
+      OS_Bench_Record(Bench_PhaseStat[Bench_Phase], now - Bench_T0);
+      Bench_T0 = 0;
+    }
+    if(Bench_Phase == BENCH_PHASE_SEMAPHORE){
+      SemaphoreTake(&Bench_Semaphore, &Bench_SleeperTask);
+    }
+    else if(Bench_Phase == BENCH_PHASE_NOTIFY){
+      OS_TaskNotifyWait(0xFFFFFFFFU, OS_WAIT_FOREVER, NULL_PTR);
+    }
+    else{
+      OS_HoldTask(&Bench_SleeperTask);
+    }
+  }
+}
+
+void Bench_Waker(void){
+  
+  while(1){
+    //Created ready like every task: wait for Bench_Control to start a round
+    OS_HoldTask(&Bench_WakerTask);
+    
+    Bench_Phase = BENCH_PHASE_ACTIVATE;
+    for(uint32 i = 0; i < OS_BENCH_SAMPLES; i++){
+      Bench_T0 = OS_PORT_CYCLES();
+      OS_ActivateTask(&Bench_SleeperTask);
+    }
+  
+    //Park the sleeper on the semaphore before timing the gives
+    Bench_Phase = BENCH_PHASE_SEMAPHORE;
+    OS_ActivateTask(&Bench_SleeperTask);
+    for(uint32 i = 0; i < OS_BENCH_SAMPLES; i++){
+      Bench_T0 = OS_PORT_CYCLES();
+      SemaphoreGive(&Bench_Semaphore);
+    }
+    
+    //Then on its notification
+    Bench_Phase = BENCH_PHASE_NOTIFY;
+    SemaphoreGive(&Bench_Semaphore);
+    for(uint32 i = 0; i < OS_BENCH_SAMPLES; i++){
+      Bench_T0 = OS_PORT_CYCLES();
+      OS_TaskNotify(&Bench_SleeperTask, 1U, OS_NOTIFY_INCREMENT);
+    }
+    
+    //Back to OS_HoldTask for the next round
+    Bench_Phase = BENCH_PHASE_ACTIVATE;
+    OS_TaskNotify(&Bench_SleeperTask, 1U, OS_NOTIFY_INCREMENT);
+  }
+}
+
+/* Load for the tick sweep: periodic tasks with spread periods that only suspend themselves */
+void Bench_Dummy(void){
+  
+  while(1){
+    OS_HoldTask(OS_GetCurrentTask());
+  }
+}
+
+static void Bench_AddDummies(uint32 Count){
+  
+  Task_ref* pTask;
+  
+  while((Count != 0) && (Bench_DummiesNo < OS_BENCH_MAX_DUMMIES)){
+    pTask = &Bench_Dummies[Bench_DummiesNo];
+    pTask->StackSize = 256;
+    pTask->Priority = 4;
+    pTask->p_TaskEntry = Bench_Dummy;
+    pTask->TimingWaiting.Blocking = BlockingEnabled;
+    pTask->TimingWaiting.Ticks_Count = 7 + 3 * Bench_DummiesNo;
+    pTask->TaskName[0] = 'D';
+    OS_CreateTask(pTask);
+    Bench_DummiesNo++;
+    Count--;
+  }
+}
+
+/* Highest priority, wakes every OS_BENCH_WINDOW_TICKS to report the window that just ended */
+void Bench_Control(void){
+  
+  uint32 step = 0;
+  
+  //First activation comes at tick 1, start the measurement windows from there
+  OS_HoldTask(&Bench_ControlTask);
+  
+  OS_Bench_Reset(&Bench_ActivateStat);
+  OS_Bench_Reset(&Bench_GiveStat);
+  OS_Bench_Reset(&Bench_NotifyStat);
+  OS_Bench_Reset(&OS_Bench_SVCStat);
+  OS_Bench_Reset(&OS_Bench_IRQLatencyStat);
+  OS_ActivateTask(&Bench_WakerTask);
+  
+  while(1){
+    OS_HoldTask(&Bench_ControlTask);
+  
+    if(step == 0){
+      OS_Bench_Print("\r\n== latency ==\r\n");
+      OS_Bench_Print("clock=");
+      OS_Bench_PrintNumber(OS_PORT_CYCLES_PER_SECOND);
+      OS_Bench_Print(" " OS_PORT_CYCLES_UNIT "/s\r\n");
+      OS_Bench_Report(&Bench_ActivateStat);
+      OS_Bench_Report(&Bench_GiveStat);
+      OS_Bench_Report(&Bench_NotifyStat);
+      OS_Bench_Report(&OS_Bench_SVCStat);
+      OS_Bench_Print("\r\n== tick cost vs periodic tasks ==\r\n");
+    }
+    else{
+      OS_Bench_Print("tasks=");
+      OS_Bench_PrintNumber(Bench_DummiesNo);
+      OS_Bench_Print(" ");
+      OS_Bench_Report(&OS_Bench_TickStat);
+      if(Bench_DummiesNo >= OS_BENCH_MAX_DUMMIES){
+        OS_Bench_Print("\r\n== application IRQ latency ==\r\n");
+        OS_Bench_Report(&OS_Bench_IRQLatencyStat);
+        OS_Bench_Print("\r\n== stack usage ==\r\n");
+        OS_Bench_StackReport();
+        OS_Bench_Print("\r\n== CPU load ==\r\n");
+        OS_Bench_LoadReport();
+#if defined(OS_PORT_POSIX)
+        exit(0);
+#else
+        OS_TerminateTask(&Bench_ControlTask);
+#endif
+      }
+      Bench_AddDummies(OS_BENCH_TASK_STEP);
+    }
+    OS_Bench_Reset(&OS_Bench_TickStat);
+    step++;
+  }
+}
+
+
+int main(void){
+  
+  OS_Bench_Reset(&OS_Bench_TickStat);
+  OS_Init();
+  OS_Bench_Init();
+  
+  OS_CreateTask(&Bench_ControlTask);
+  OS_CreateTask(&Bench_SleeperTask);
+  OS_CreateTask(&Bench_WakerTask);
+  
+  OS_Start();
+  
+  while(1){
+  
+  }
+}
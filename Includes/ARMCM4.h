@@ -94,7 +94,7 @@ typedef enum IRQn
 #define __VTOR_PRESENT            1U        /* VTOR present */
 #define __NVIC_PRIO_BITS          3U        /* Number of Bits used for Priority Levels */
 #define __Vendor_SysTickConfig    0U        /* Set to 1 if different SysTick Config is used */
-#define __FPU_PRESENT             0U        /* no FPU present */
+#define __FPU_PRESENT             1U        /* FPU present (TM4C123GH6PM is a Cortex-M4F) */
 
 #include "core_cm4.h"                       /* Processor and core peripherals */
 #include "system_ARMCM4.h"                  /* System Header */
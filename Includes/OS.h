@@ -1,37 +1,37 @@
 #ifndef _Schedular_H_
 #define _Schedular_H_
 
-#include "ARMCM4.h"
-#include "tm4c123gh6pm.h"
-#include "systick.h"
 #include "Schedular_Cfg.h"
 #include "types.h"
+#include "OS_Port.h"
 
 
-#define OS_SET_PSP(add)        __asm volatile("MOV r0, %0 \n\t MSR PSP, r0" : : "r"(add))
-#define OS_GET_PSP(add)        __asm volatile("MRS r0, PSP \n\t MOV %0, r0"  :  "=r"(add))
+/* Ready bitmap: priority 0 maps to bit 31 so OS_PORT_CLZ returns the highest ready priority */
+#define OS_PRIORITY_BIT(prio)  (0x80000000UL >> (prio))
 
+/* Timeouts of blocking calls, in ticks */
+#define OS_NO_WAIT             0U
+#define OS_WAIT_FOREVER        0xFFFFFFFFU
 
-#define OS_SET_SP_TO_PSP       __asm volatile( "MRS r0, CONTROL   \n\t"\
-"MOV r1, #0x2      \n\t"\
-  "ORR r0, r1, r0    \n\t"\
-    "MSR CONTROL, r1");
+/* How a blocking call ended */
+#define OS_WAIT_OK             0U
+#define OS_WAIT_TIMEOUT        1U
 
-#define OS_SET_SP_TO_MSP       __asm volatile( "mrs r0, CONTROL   \n\t"\
-"mov r1, #0b101    \n\t"\
-  "and r0, r0, r1    \n\t"\
-    "msr CONTROL, r0");
+/* EventGroupWait options */
+#define OS_EVENT_WAIT_ANY      0x00U     /* Wake when any of the flags is set */
+#define OS_EVENT_WAIT_ALL      0x01U     /* Wake when all of the flags are set */
+#define OS_EVENT_CLEAR         0x02U     /* Clear the flags waited for when the wait is satisfied */
 
-#define CPUAccess_Privileged	__asm("mrs r3, CONTROL	\n\t" \
-"lsr r3, r3, #0x1	\n\t" \
-  "lsl r3, r3, #0x1	\n\t" \
-    "msr CONTROL, r3");
+/* OS_TaskNotify actions on the task's notification value */
+#define OS_NOTIFY_SET_BITS     0x00U     /* OR Value in, e.g. one bit per event source */
+#define OS_NOTIFY_INCREMENT    0x01U     /* Add one, a counting semaphore private to the task */
+#define OS_NOTIFY_OVERWRITE    0x02U     /* Replace it, a one-slot mailbox */
 
-#define CPUAccess_Unprivileged	__asm( "mrs r3, CONTROL  \n\t" \
-"orr r3, r3, #0x1 \n\t" \
-  "msr CONTROL, r3");
+struct Mutex;
 
-typedef struct{
+typedef struct Task_ref{
+  
+  uint32* Current_PSP;          /* Must stay the first member: PendSV_Handler reads/writes it at offset 0 */
   
   uint32 StackSize;
   uint8  Priority;
@@ -39,7 +39,9 @@ typedef struct{
   
   uint32* _S_PSP_Task;
   uint32* _E_PSP_Task;
-  uint32* Current_PSP;
+#if defined(OS_PORT_POSIX)
+  void*   PortContext;          /* ucontext_t of the host port */
+#endif
   
   uint8 TaskName[30];
   enum{
@@ -57,6 +59,56 @@ typedef struct{
     unsigned int Ticks_Count;
   }TimingWaiting;
   
+  /* Links of the per-priority ready list, owned by the kernel */
+  struct Task_ref* p_NextReady;
+  struct Task_ref* p_PrevReady;
+  
+  /* Links of the delta-ordered delay list, DelayTicks is relative to the previous entry */
+  struct Task_ref* p_NextDelay;
+  struct Task_ref* p_PrevDelay;
+  uint32           DelayTicks;
+  
+  /* Priority inheritance: Priority is the effective priority, BasePriority the configured one */
+  uint8            BasePriority;
+  struct Mutex*    p_WaitingMutex;       /* Mutex this task is blocked on */
+  struct Mutex*    p_HeldMutexes;        /* Mutexes owned by this task */
+  
+  /* Kernel object wait: head of the wait list the task is queued on, and how its last wait ended */
+  struct Task_ref** p_WaitList;
+  uint8            WaitResult;
+  void*            WaitMessage;          /* Message being sent or received by a queue call */
+  uint32           WaitFlags;            /* Event flags waited for, then the flags that ended the wait */
+  uint8            WaitOptions;          /* OS_EVENT_WAIT_* of that wait */
+  
+  uint32           StackHighWater;       /* Most stack bytes used so far, refreshed by IDLETASK */
+  
+  /* Round robin: quantum among equal priorities (0 for OS_TIME_SLICE) and the ticks left of it */
+  uint32           TimeSlice;
+  uint32           SliceTicks;
+  
+  /* Direct-to-task notification: no separate object, the task waits on its own one-entry list */
+  uint32           NotifyValue;
+  boolean          NotifyPending;
+  struct Task_ref* p_NotifyWaiter;       /* The task itself while blocked in OS_TaskNotifyWait */
+  
+  /* EDF (tasks at OS_EDF_PRIORITY): deadline relative to each activation, 0 for Ticks_Count */
+  uint32           RelativeDeadline;
+  uint32           AbsoluteDeadline;
+  uint32           HeapIndex;            /* Position in the deadline heap while ready */
+  
+#if OS_TRACE
+  uint8            TraceId;              /* Index of the task in OS_Trace's header */
+#endif
+  
+#if OS_RUNTIME_STATS
+  /* Run-time statistics in OS_PORT_CYCLES() units, charged on every context switch */
+  uint64           RunCycles;
+  uint64           WindowStartCycles;    /* RunCycles when the current load window started */
+  uint32           SwitchInNo;
+  uint32           PreemptedNo;          /* Switched out while still ready */
+  uint32           WindowCycles;         /* Cycles run in the last complete window */
+#endif
+  
 }Task_ref;
 
 
@@ -69,26 +121,215 @@ typedef struct{
 }BinarySemaphore;
 
 
+/* Priority-inheritance mutex: recursive for its owner, waiters queued highest priority first
+   (the ready-list links of a blocked task are reused for the wait list) */
+typedef struct Mutex{
+  
+  Task_ref*     Owner;
+  uint32        LockCount;
+  Task_ref*     p_WaitHead;
+  struct Mutex* p_NextHeld;
+  uint8         MutexName[30];
+  
+}Mutex;
+
+
+/* Counting semaphore: waiters queued highest priority first, optional timeout on take */
+typedef struct{
+  
+  uint32    Count;
+  Task_ref* p_WaitHead;
+  uint8     SemaphoreName[30];
+  
+}CountingSemaphore;
+
+
+/* Message queue of pointers: messages are passed by reference, never copied. Buffer holds
+   Length slots supplied by the application; blocked senders and receivers queue by priority. */
+typedef struct{
+  
+  void**    Buffer;
+  uint32    Length;
+  uint32    Head;
+  uint32    Count;
+  Task_ref* p_SendWaitHead;
+  Task_ref* p_ReceiveWaitHead;
+  uint8     QueueName[30];
+  
+}MessageQueue;
+
+
+/* Event group: 32 flags that tasks wait on with any/all conditions */
+typedef struct{
+  
+  uint32    Flags;
+  Task_ref* p_WaitHead;
+  uint8     EventGroupName[30];
+  
+}EventGroup;
+
+
+/* Software timer: Callback runs in TIMERTASK Period ticks after a start, once or every Period */
+#define OS_TIMER_ONE_SHOT          0U
+#define OS_TIMER_PERIODIC          1U
+
+/* SoftwareTimer.State bits, owned by the kernel */
+#define OS_TIMER_ACTIVE            0x01U    /* In the active list */
+#define OS_TIMER_QUEUED            0x02U    /* In TIMERTASK's expired list */
+#define OS_TIMER_DUE               0x04U    /* Callback still to run */
+
+typedef struct SoftwareTimer{
+  
+  void(*p_Callback)(struct SoftwareTimer* Timer);
+  void*   p_Context;                          /* Free for the callback */
+  uint32  Period;
+  uint8   Mode;
+  uint8   State;
+  
+  /* Active list ordered by expiry, DeltaTicks relative to the previous entry */
+  struct SoftwareTimer* p_Next;
+  struct SoftwareTimer* p_Prev;
+  uint32  DeltaTicks;
+  struct SoftwareTimer* p_NextExpired;
+  
+  uint8   TimerName[30];
+  
+}SoftwareTimer;
+
+
+/* Fixed-block memory pool: the free list is threaded through the free blocks themselves
+   (word 0: next free block, word 1: free marker, checked against the free list to catch double frees) */
+#define OS_MEMPOOL_OK              0U
+#define OS_MEMPOOL_INVALID         1U
+
+#define OS_MEMPOOL_FREE_MAGIC      ((uintptr_t)0xF4EEB10CUL)
+#define OS_MEMPOOL_FREE_MARK(blk)  ((uintptr_t)(blk) ^ OS_MEMPOOL_FREE_MAGIC)
+
+/* Blocks are rounded up to whole pointers, two at least for the free-list links */
+#define OS_MEMPOOL_BLOCK_WORDS(size) \
+  (((size) + sizeof(uintptr_t) - 1U) / sizeof(uintptr_t) < 2U ? 2U : ((size) + sizeof(uintptr_t) - 1U) / sizeof(uintptr_t))
+
+/* Static storage for a pool of BlocksNo blocks of BlockSize bytes */
+#define OS_MEMPOOL_BUFFER(name, BlockSize, BlocksNo) \
+  uintptr_t name[OS_MEMPOOL_BLOCK_WORDS(BlockSize) * (BlocksNo)]
+
+typedef struct{
+  
+  uintptr_t* p_FreeHead;
+  uint8*     p_Start;
+  uint8*     p_End;
+  uint32     BlockSize;
+  uint32     BlocksNo;
+#if OS_MEMPOOL_STATS
+  uint32     UsedNo;
+  uint32     PeakUsedNo;
+  uint32     FailedNo;            /* Allocations refused because the pool was empty */
+  uint32     InvalidFreeNo;       /* Frees refused: foreign pointer or double free */
+#endif
+  uint8      PoolName[30];
+  
+}MemPool;
+
+
 typedef struct
 {
   Task_ref Tasks[TasksNo];
 }Task_Config;
 
+
+#if OS_STATIC_TASKS
+/* Static stack of Size bytes (whole 8-byte units), left uninitialised: OS_Init builds the frame */
+#define OS_STATIC_STACK_WORDS(Size)   ((((Size) + 7U) / 8U) * 2U)
+#define OS_STATIC_STACK(name, Size) \
+  uint32 name[OS_STATIC_STACK_WORDS(Size)] OS_PORT_STACK_ATTRIBUTE
+
+/* Task_ref initialisers pointing a statically configured task at its OS_STATIC_STACK */
+#define OS_STATIC_TASK_STACK(name) \
+  ._S_PSP_Task = &name[sizeof(name) / sizeof(name[0])], \
+  ._E_PSP_Task = &name[0]
+
+/* Placement of the statically configured TCBs, next to their stacks */
+#define OS_STATIC_TASK_ATTRIBUTE      OS_PORT_TASK_ATTRIBUTE
+#else
+#define OS_STATIC_TASK_ATTRIBUTE
+#endif
+
 typedef struct{
     BinarySemaphore*       BinarySemaphores[BinarySemaphoreNo]; 
 }Semaphore_Config;
 
+typedef struct{
+    Mutex*                 Mutexes[MutexNo];
+}Mutex_Config;
+
 void OS_Init(void);
 void OS_CreateTask(Task_ref* Task);
 void OS_ActivateTask(Task_ref* Task);
 void OS_TerminateTask(Task_ref* Task);
 void OS_HoldTask(Task_ref* Task);
 uint32 OS_GetTime(void);
+uint64 OS_GetTimeUs(void);
+void OS_TickSync(void);
+Task_ref* OS_GetCurrentTask(void);
+Task_ref* OS_GetTask(uint32 Index);
 void OS_Start(void);
 
+void OS_TaskNotify(Task_ref* Task, uint32 Value, uint8 Action);
+uint8 OS_TaskNotifyWait(uint32 ClearOnExit, uint32 Timeout, uint32* pValue);
+
 void SemaphoreTake(BinarySemaphore* Semaphore, Task_ref* task);
 void SemaphoreGive(BinarySemaphore* Semaphore);
 
+void MutexLock(Mutex* pMutex);
+void MutexUnlock(Mutex* pMutex);
+
+uint8 CountingSemaphoreTake(CountingSemaphore* pSemaphore, uint32 Timeout);
+void CountingSemaphoreGive(CountingSemaphore* pSemaphore);
+
+void MessageQueueInit(MessageQueue* pQueue, void** Buffer, uint32 Length);
+uint8 MessageQueueSend(MessageQueue* pQueue, void* Message, uint32 Timeout);
+uint8 MessageQueueReceive(MessageQueue* pQueue, void** pMessage, uint32 Timeout);
+uint8 MessageQueueSendFromISR(MessageQueue* pQueue, void* Message);
+uint8 MessageQueueReceiveFromISR(MessageQueue* pQueue, void** pMessage);
+
+#if OS_STACK_CHECK
+uint32 OS_GetStackHighWater(Task_ref* Task);
+uint32 OS_GetStackSuggestedSize(Task_ref* Task);
+boolean OS_StackOverflowed(const Task_ref* Task);
+#endif
+
+#if OS_RUNTIME_STATS
+/* Consistent copy of a task's statistics */
+typedef struct{
+  
+  uint64    RunCycles;
+  uint32    SwitchInNo;
+  uint32    PreemptedNo;
+  uint32    LoadPermille;
+  
+}OS_RunTimeStats;
+
+void OS_GetRunTimeStats(const Task_ref* Task, OS_RunTimeStats* pStats);
+uint32 OS_GetCpuLoad(const Task_ref* Task);
+uint32 OS_GetIdleLoad(void);
+#endif
+
+void EventGroupSet(EventGroup* pGroup, uint32 Flags);
+void EventGroupClear(EventGroup* pGroup, uint32 Flags);
+uint8 EventGroupWait(EventGroup* pGroup, uint32 Flags, uint8 Options, uint32 Timeout, uint32* pFlags);
+
+#if OS_SOFTWARE_TIMERS
+void SoftwareTimerCreate(SoftwareTimer* pTimer, void(*Callback)(SoftwareTimer* Timer), uint32 Period, uint8 Mode);
+void SoftwareTimerStart(SoftwareTimer* pTimer);
+void SoftwareTimerStop(SoftwareTimer* pTimer);
+void SoftwareTimerReset(SoftwareTimer* pTimer);
+#endif
+
+void MemPoolInit(MemPool* pPool, void* Buffer, uint32 BlockSize, uint32 BlocksNo);
+void* MemPoolAlloc(MemPool* pPool);
+uint8 MemPoolFree(MemPool* pPool, void* Block);
+
 extern Task_Config Tasks_Configuration;
 extern Semaphore_Config BinarySem;
+extern Mutex_Config Mutexes_Configuration;
 #endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef _OS_BENCH_H_
+#define _OS_BENCH_H_
+
+/*
+ * Kernel benchmark support: min/avg/max and a fixed-width histogram per measured path,
+ * printed over UART0 (115200 8N1) on the target or stdout on the host port.
+ * Times are OS_PORT_CYCLES() units: core cycles (DWT->CYCCNT) on the target, ns on the host.
+ * Bench/OS_Bench_Main.c is the benchmark target built with OS_BENCHMARK = 1.
+ */
+
+#include "Schedular.h"
+
+#define OS_BENCH_BUCKETS          16U
+#if defined(OS_PORT_POSIX)
+#define OS_BENCH_BUCKET_WIDTH     500U     /* Histogram bucket width in OS_PORT_CYCLES() units */
+#else
+#define OS_BENCH_BUCKET_WIDTH     32U
+#endif
+
+typedef struct{
+
+  const char* Name;
+  uint32      Count;
+  uint32      Min;
+  uint32      Max;
+  uint64      Sum;
+  uint32      Histogram[OS_BENCH_BUCKETS];      /* Last bucket also counts everything above it */
+
+}OS_BenchStat;
+
+extern OS_BenchStat OS_Bench_TickStat;
+extern OS_BenchStat OS_Bench_SVCStat;
+extern OS_BenchStat OS_Bench_IRQLatencyStat;
+
+void OS_Bench_Init(void);
+void OS_Bench_Reset(OS_BenchStat* Stat);
+void OS_Bench_Record(OS_BenchStat* Stat, uint32 Value);
+void OS_Bench_Report(const OS_BenchStat* Stat);
+void OS_Bench_Print(const char* Text);
+void OS_Bench_PrintNumber(uint32 Value);
+void OS_Bench_StackReport(void);
+void OS_Bench_LoadReport(void);
+
+#endif
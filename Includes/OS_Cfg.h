@@ -2,8 +2,58 @@
 #define _SCHEDULAR_CFG_H_
 
 
-#define TasksNo                 9U
+#ifndef TasksNo
+#define TasksNo                 10U      /* Application tasks + IDLETASK + TIMERTASK */
+#endif
 #define BinarySemaphoreNo       2U
+#define MutexNo                 2U
+
+#ifndef OS_STATIC_TASKS
+#define OS_STATIC_TASKS         0U       /* 1: Tasks_Configuration and its stacks are laid out at compile time,
+                                            OS_Init links them in and main does not call OS_CreateTask */
+#endif
+
+#define OS_PRIORITY_LEVELS      32U      /* Priorities 0 (highest) .. 31 (lowest) */
+
+#ifndef OS_SCHEDULER_EDF
+#define OS_SCHEDULER_EDF        0U       /* 1: tasks at OS_EDF_PRIORITY run earliest absolute deadline first */
+#endif
+#define OS_EDF_PRIORITY         5U       /* Priority level scheduled by deadline, others stay fixed priority */
+
+#ifndef OS_TIME_SLICE
+#define OS_TIME_SLICE           1U       /* Default ticks a task runs before yielding to its equal-priority peers */
+#endif
+
+#define OS_TICKLESS_IDLE        1U       /* 1: stretch SysTick while only IDLETASK is ready */
+#define OS_TICKLESS_MIN_IDLE    2U       /* Shortest idle period (ticks) worth reprogramming SysTick */
+
+#define OS_SOFTWARE_TIMERS      1U       /* 1: SoftwareTimer callbacks run in TIMERTASK (counts in TasksNo) */
+#define OS_TIMER_TASK_PRIORITY  0U       /* Callbacks preempt every task: keep them short */
+#define OS_TIMER_TASK_STACK     300U
+
+#define OS_STACK_CHECK          1U       /* 1: paint task stacks and track their high-water marks */
+#define OS_STACK_PAINT          0xA5A5A5A5U
+#define OS_STACK_MARGIN         32U      /* Bytes added to the high-water mark by OS_GetStackSuggestedSize */
+
+#define OS_MEMPOOL_STATS        1U       /* 1: track used/peak/failed counts in every MemPool */
+
+#ifndef OS_RUNTIME_STATS
+#define OS_RUNTIME_STATS        1U       /* 1: per-task run cycles, switch/preemption counts and CPU load */
+#endif
+#define OS_RUNTIME_WINDOW       1000U    /* Ticks of the tumbling window OS_GetCpuLoad reports on */
+
+#ifndef OS_TRACE
+#define OS_TRACE                0U       /* 1: record kernel events in RAM for Tools/os_trace.py (OS_Trace.h) */
+#endif
+#define OS_TRACE_EVENTS         512U     /* Trace ring length, a power of two (8 bytes per event) */
+
+#ifndef OS_BENCHMARK
+#define OS_BENCHMARK            0U       /* 1: record SVC/SysTick handler costs for OS_Bench (Bench/OS_Bench_Main.c) */
+#endif
+
+#ifndef OS_PRIVILEGED_TASKS
+#define OS_PRIVILEGED_TASKS     0U       /* 1: tasks stay privileged, e.g. to read DWT->CYCCNT */
+#endif
 
 #define MCAL_Peripherals_Used   2U
 
@@ -23,6 +73,10 @@
 #define SwitchStatesSempahore         (BinarySem.BinarySemaphores[0])
 #define SendStatesSempahore         (BinarySem.BinarySemaphores[1])
 
+/* Shared resources: priority-inheritance mutexes, the semaphores above are for signalling */
+#define SwitchStatesMutex             (Mutexes_Configuration.Mutexes[0])
+#define SendStatesMutex               (Mutexes_Configuration.Mutexes[1])
+
 
 
 
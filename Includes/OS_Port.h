@@ -0,0 +1,63 @@
+#ifndef _OS_PORT_H_
+#define _OS_PORT_H_
+
+/*
+ * Architecture layer of the kernel.
+ * OS.c only talks to the machine through the macros and functions below; every port header
+ * provides:
+ *   OS_SVC(num, arg)          enter the kernel, OS_SVC_Service(num, args) runs with args[0] = arg
+ *   OS_SVC2(num, arg0, arg1)  same with args[0] = arg0, args[1] = arg1
+ *   OS_PORT_CLZ(x)            count leading zeros of a non-zero 32-bit value
+ *   OS_PORT_PEND_SWITCH()     request a switch to OS_Control.NextTask at kernel exit
+ *   OS_PORT_WAIT_FOR_EVENT()  sleep in IDLETASK until the next interrupt
+ *   OS_PORT_ENTER_CRITICAL(s) / OS_PORT_EXIT_CRITICAL(s)
+ *                             keep SVC and the tick out of kernel calls made by interrupt
+ *                             handlers, s is an OS_Port_CriticalState
+ *   OS_PORT_IN_HANDLER()      non-zero where the critical section can be used instead of SVC
+ *   OS_PORT_ATOMIC_INC(p)     add one to the uint32 at p, return its old value, lock free
+ *   OS_PORT_ATOMIC_CAS(p,o,n) store n at the uint32 at p if it still holds o, non-zero on success
+ *   OS_PORT_MEMORY_BARRIER()  order memory accesses before and after it
+ *   OS_PORT_CYCLES_PER_SECOND rate of OS_PORT_CYCLES()
+ *   OS_PORT_TICK_COUNTS       OS_Port_TickCounts() units in one tick
+ * and, for OS_STATIC_TASKS:
+ *   OS_PORT_STACK_ATTRIBUTE   alignment/section of static stacks, not loaded from the image
+ *   OS_PORT_TASK_ATTRIBUTE    section of the static TCBs
+ *
+ * Build with OS_PORT_POSIX defined to run the kernel as a Linux process, otherwise the
+ * Cortex-M4 (TM4C123GH6PM) port is used.
+ */
+
+#include <stdint.h>
+#include "types.h"
+
+#if defined(OS_PORT_POSIX)
+#include "OS_Port_Posix.h"
+#else
+#include "OS_Port_CM4.h"
+#endif
+
+struct Task_ref;
+
+/* Implemented by the port */
+void   OS_Port_Init(void);
+void   OS_Port_InitTaskStack(struct Task_ref* Task);
+/* Initial frame of a task whose stack bounds are already set (OS_STATIC_TASKS) */
+void   OS_Port_InitStaticStack(struct Task_ref* Task);
+void   OS_Port_StartFirstTask(struct Task_ref* Task);
+void   OS_Port_SuppressTicks(uint32 Ticks);
+void   OS_Port_ResumeTicks(void);
+/* Tick timer counts since the last tick OS_Tick_Advance counted, with the tick masked;
+   includes a tick period that ended but whose interrupt is still pending */
+uint32 OS_Port_TickCounts(void);
+
+/* Kernel services the port calls from its exception/signal handlers */
+void   OS_SVC_Service(uint32 SVC_Number, uintptr_t* Args);
+void   OS_Tick_Advance(uint32 Ticks);
+void   OS_Tick_Service(uint32 Ticks);
+struct Task_ref* OS_Switch_Commit(void);
+#define OS_SWITCH_HOOK (OS_RUNTIME_STATS || OS_TRACE)
+#if OS_SWITCH_HOOK
+void   OS_Switch_Hook(struct Task_ref* Previous, struct Task_ref* Next);
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef _OS_PORT_CM4_H_
+#define _OS_PORT_CM4_H_
+
+#include "ARMCM4.h"
+#include "tm4c123gh6pm.h"
+#include "systick.h"
+#include "clock.h"
+
+
+#define OS_SET_PSP(add)        __asm volatile("MOV r0, %0 \n\t MSR PSP, r0" : : "r"(add))
+#define OS_GET_PSP(add)        __asm volatile("MRS r0, PSP \n\t MOV %0, r0"  :  "=r"(add))
+
+
+#define OS_SET_SP_TO_PSP       __asm volatile( "MRS r0, CONTROL   \n\t"\
+"MOV r1, #0x2      \n\t"\
+  "ORR r0, r1, r0    \n\t"\
+    "MSR CONTROL, r1");
+
+#define OS_SET_SP_TO_MSP       __asm volatile( "mrs r0, CONTROL   \n\t"\
+"mov r1, #0b101    \n\t"\
+  "and r0, r0, r1    \n\t"\
+    "msr CONTROL, r0");
+
+#define CPUAccess_Privileged	__asm("mrs r3, CONTROL	\n\t" \
+"lsr r3, r3, #0x1	\n\t" \
+  "lsl r3, r3, #0x1	\n\t" \
+    "msr CONTROL, r3");
+
+#define CPUAccess_Unprivileged	__asm( "mrs r3, CONTROL  \n\t" \
+"orr r3, r3, #0x1 \n\t" \
+  "msr CONTROL, r3");
+
+/* Raise SVC #num with arg passed to the handler in the stacked r0 */
+#define OS_SVC(num, arg)       __asm volatile("mov r0, %0 \n\t svc #" #num : : "r"(arg) : "r0", "memory")
+#define OS_SVC2(num, arg0, arg1) __asm volatile("mov r0, %0 \n\t mov r1, %1 \n\t svc #" #num \
+                                                : : "r"(arg0), "r"(arg1) : "r0", "r1", "memory")
+
+#define OS_PORT_CLZ(x)         __CLZ(x)
+#define OS_PORT_PEND_SWITCH()  (SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk)
+#define OS_PORT_WAIT_FOR_EVENT() __asm("wfe")
+
+/* Handler mode only: PRIMASK is ignored for unprivileged thread code */
+typedef uint32 OS_Port_CriticalState;
+#define OS_PORT_ENTER_CRITICAL(state)  do{ (state) = __get_PRIMASK(); __disable_irq(); }while(0)
+#define OS_PORT_EXIT_CRITICAL(state)   __set_PRIMASK(state)
+#define OS_PORT_IN_HANDLER()           (__get_IPSR() != 0U)
+
+/* Static stacks take no flash and are not copied at startup (.bss, frames built by OS_Init);
+   the TCBs carry their configuration so they stay initialised data, in their own section */
+#define OS_PORT_STACK_ATTRIBUTE        __attribute__((aligned(8), section(".bss.os_stack")))
+#define OS_PORT_TASK_ATTRIBUTE         __attribute__((section(".data.os_task")))
+
+/* Free-running core cycle counter, enabled by OS_Port_Init (privileged access only) */
+#define OS_PORT_CYCLES()       (DWT->CYCCNT)
+#define OS_PORT_CYCLES_UNIT    "cycles"
+#define OS_PORT_CYCLES_PER_SECOND  SystemCoreClock
+
+/* SysTick counts per 1 ms tick */
+#define OS_PORT_TICK_COUNTS    SYSTICK_COUNTS_PER_MS
+
+/* Add one to *p and return the old value, safe against any interrupt without masking */
+static inline uint32 OS_Port_AtomicInc(volatile uint32* p){
+  
+  uint32 old;
+  
+  do{
+    old = __LDREXW((volatile uint32_t*)p);
+  }while(__STREXW(old + 1U, (volatile uint32_t*)p) != 0U);
+  return old;
+}
+#define OS_PORT_ATOMIC_INC(p)  OS_Port_AtomicInc(p)
+
+static inline uint32 OS_Port_AtomicCas(volatile uint32* p, uint32 Old, uint32 New){
+  
+  do{
+    if(__LDREXW((volatile uint32_t*)p) != Old){
+      __CLREX();
+      return 0;
+    }
+  }while(__STREXW(New, (volatile uint32_t*)p) != 0U);
+  return 1;
+}
+#define OS_PORT_ATOMIC_CAS(p, o, n)  OS_Port_AtomicCas((p), (o), (n))
+#define OS_PORT_MEMORY_BARRIER() __DMB()
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _OS_PORT_POSIX_H_
+#define _OS_PORT_POSIX_H_
+
+/*
+ * Linux host port: tasks are ucontexts on a single thread, SysTick is a 1 ms SIGALRM
+ * (setitimer) and SVC is a plain call with SIGALRM blocked. PendSV becomes a flag that is
+ * served at the end of every kernel entry.
+ *
+ * Build example (application task sources added as needed):
+ *   gcc -DOS_PORT_POSIX -IIncludes main.c Source/OS.c Source/OS_Cfg.c Source/OS_Port_Posix.c ...
+ */
+
+#include <signal.h>
+#include <stdint.h>
+#include "types.h"
+
+/* ucontext frames of host code need far more than the StackSize configured for the target */
+#define OS_PORT_POSIX_MIN_STACK      (64U * 1024U)
+
+uintptr_t OS_Posix_SVC(uint32 SVC_Number, uintptr_t Arg0, uintptr_t Arg1);
+void      OS_Posix_PendSwitch(void);
+void      OS_Posix_WaitForEvent(void);
+uint32    OS_Posix_Cycles(void);
+void      OS_Posix_EnterCritical(sigset_t* State);
+void      OS_Posix_ExitCritical(const sigset_t* State);
+
+#define OS_SVC(num, arg)        ((void)OS_Posix_SVC((num), (uintptr_t)(arg), 0))
+#define OS_SVC2(num, arg0, arg1) ((void)OS_Posix_SVC((num), (uintptr_t)(arg0), (uintptr_t)(arg1)))
+
+#define OS_PORT_CLZ(x)          ((uint32)__builtin_clz(x))
+#define OS_PORT_PEND_SWITCH()   OS_Posix_PendSwitch()
+#define OS_PORT_WAIT_FOR_EVENT() OS_Posix_WaitForEvent()
+
+/* Signal handlers mask the tick like an ISR masks SysTick; a pended switch is taken on exit */
+typedef sigset_t OS_Port_CriticalState;
+#define OS_PORT_ENTER_CRITICAL(state)  OS_Posix_EnterCritical(&(state))
+#define OS_PORT_EXIT_CRITICAL(state)   OS_Posix_ExitCritical(&(state))
+/* Signals can be masked from task code too, so the host always takes the critical section */
+#define OS_PORT_IN_HANDLER()           (1)
+
+/* Static stacks are unused on the host: tasks still get a ucontext from OS_Port_InitTaskStack */
+#define OS_PORT_STACK_ATTRIBUTE        __attribute__((aligned(16)))
+#define OS_PORT_TASK_ATTRIBUTE
+
+/* Host timestamps are CLOCK_MONOTONIC nanoseconds */
+#define OS_PORT_CYCLES()        OS_Posix_Cycles()
+#define OS_PORT_CYCLES_UNIT     "ns"
+#define OS_PORT_CYCLES_PER_SECOND  1000000000U
+#define OS_PORT_TICK_COUNTS     1000000U
+
+#define OS_PORT_ATOMIC_INC(p)   __atomic_fetch_add((p), 1U, __ATOMIC_RELAXED)
+#define OS_PORT_ATOMIC_CAS(p, o, n)  __sync_bool_compare_and_swap((p), (o), (n))
+#define OS_PORT_MEMORY_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* Signal standing for an application interrupt, masked during kernel entries like a
+   lower-priority IRQ is held off by SVC/SysTick on the target */
+#define OS_PORT_POSIX_IRQ_SIGNAL     SIGUSR1
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef _OS_RING_BUFFER_H_
+#define _OS_RING_BUFFER_H_
+
+/*
+ * Ring buffer of fixed-size elements, any element size, capacity a power of two.
+ * Lock free for one producer and one consumer, e.g. an ADC or UART ISR writing and a task
+ * reading: Head is only written by the producer and Tail only by the consumer, both run freely
+ * and are masked on access, and the memory barrier publishes the data before the index moves.
+ * Several producers or consumers must serialise among themselves (e.g. with a Mutex).
+ */
+
+#include "Schedular.h"
+
+#define OS_RING_OK                 0U
+#define OS_RING_INVALID            1U
+
+/* Static storage for Capacity elements of Type */
+#define OS_RING_STORAGE(name, Type, Capacity)  Type name[(Capacity)]
+
+typedef struct{
+
+  uint8*           Buffer;
+  uint32           ElementSize;
+  uint32           Mask;                 /* Capacity - 1 */
+  volatile uint32  Head;                 /* Elements written so far, producer side */
+  volatile uint32  Tail;                 /* Elements read so far, consumer side */
+
+}OS_RingBuffer;
+
+uint8  OS_RingBufferInit(OS_RingBuffer* pRing, void* Buffer, uint32 ElementSize, uint32 Capacity);
+uint32 OS_RingBufferWrite(OS_RingBuffer* pRing, const void* pData, uint32 Count);
+uint32 OS_RingBufferRead(OS_RingBuffer* pRing, void* pData, uint32 Count);
+uint32 OS_RingBufferCount(const OS_RingBuffer* pRing);
+uint32 OS_RingBufferSpace(const OS_RingBuffer* pRing);
+
+#endif
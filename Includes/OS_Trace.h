@@ -0,0 +1,106 @@
+#ifndef _OS_TRACE_H_
+#define _OS_TRACE_H_
+
+/*
+ * Kernel trace recorder (OS_TRACE = 1): fixed 8-byte events with an OS_PORT_CYCLES() timestamp
+ * in a RAM ring, decoded on the host into a Perfetto/Chrome trace by Tools/os_trace.py.
+ *
+ *   Snapshot: the ring keeps the latest OS_TRACE_EVENTS events. Stop with OS_Trace_Stop and send
+ *             them with OS_Trace_Dump, or save OS_Trace with the debugger
+ *             (gdb: dump binary value trace.bin OS_Trace).
+ *   Stream:   the ring is a FIFO that a low-priority task empties with OS_Trace_Drain, e.g. to
+ *             UART. Events that find it full are counted in Dropped.
+ *
+ * Every output begins with OS_TraceHeader. A snapshot is followed by the raw ring, a stream by
+ * the events in order. Recording timestamps with DWT->CYCCNT, so on the target it is only
+ * usable from handlers and privileged tasks.
+ *
+ * The header holds one CyclesPerSecond. Clock_Set updates it, so a snapshot decodes the events
+ * after a clock change correctly but those before it at the new rate, and a stream whose header
+ * was already sent keeps the old rate: restart the trace (OS_Trace_Start) after a clock change.
+ */
+
+#include "Schedular.h"
+
+#define OS_TRACE_OFF               0U
+#define OS_TRACE_SNAPSHOT          1U
+#define OS_TRACE_STREAM            2U
+
+#define OS_TRACE_MAGIC             0x5254534FU     /* "OSTR" */
+#define OS_TRACE_VERSION           1U
+#define OS_TRACE_NAME_LENGTH       16U
+#define OS_TRACE_NO_TASK           0xFFU
+
+/* Event types, Task is the task concerned (OS_TRACE_NO_TASK for none) */
+#define OS_TRACE_SWITCH            1U      /* Task switched in, Arg: task switched out */
+#define OS_TRACE_READY             2U      /* Task made ready */
+#define OS_TRACE_TICK              3U      /* Arg: ticks counted */
+#define OS_TRACE_SVC_ENTER         4U      /* Arg: SVC number, Task: caller */
+#define OS_TRACE_SVC_EXIT          5U
+#define OS_TRACE_SEM_TAKE          6U      /* Arg: low 16 bits of the semaphore address */
+#define OS_TRACE_SEM_BLOCK         7U
+#define OS_TRACE_SEM_GIVE          8U
+#define OS_TRACE_ISR_ENTER         9U      /* Arg: interrupt number */
+#define OS_TRACE_ISR_EXIT          10U
+#define OS_TRACE_USER              11U     /* Arg: application defined */
+
+typedef struct{
+
+  uint32    Timestamp;
+  uint8     Type;                       /* Written last, 0 while the slot is being filled */
+  uint8     Task;
+  uint16    Arg;
+
+}OS_TraceEvent;
+
+typedef struct{
+
+  uint32    Magic;
+  uint8     Version;
+  uint8     Mode;
+  uint8     EventSize;
+  uint8     TaskCount;
+  uint32    Capacity;
+  uint32    Head;                       /* Events recorded since the start, next slot Head % Capacity */
+  uint32    Tail;                       /* Stream: next event to drain */
+  uint32    Dropped;
+  uint32    CyclesPerSecond;
+  uint8     TaskNames[TasksNo][OS_TRACE_NAME_LENGTH];
+
+}OS_TraceHeader;
+
+typedef struct{
+
+  OS_TraceHeader Header;
+  OS_TraceEvent  Events[OS_TRACE_EVENTS];
+
+}OS_TraceBuffer;
+
+#if OS_TRACE
+
+extern OS_TraceBuffer OS_Trace;
+
+void OS_Trace_Record(uint8 Type, uint8 Task, uint16 Arg);
+void OS_Trace_AddTask(Task_ref* Task, uint32 Index);
+void OS_Trace_Start(uint8 Mode);
+void OS_Trace_Stop(void);
+void OS_Trace_Dump(void(*Write)(const void* Data, uint32 Length));
+uint32 OS_Trace_Drain(void(*Write)(const void* Data, uint32 Length));
+
+/* task may be NULL, e.g. CurrentTask for SVCs made before OS_Start */
+#define OS_TRACE_EVENT(type, task, arg) \
+  OS_Trace_Record((type), ((task) != NULL_PTR) ? (task)->TraceId : OS_TRACE_NO_TASK, (uint16)(arg))
+#define OS_TRACE_ISR_BEGIN(irq)          OS_Trace_Record(OS_TRACE_ISR_ENTER, OS_TRACE_NO_TASK, (uint16)(irq))
+#define OS_TRACE_ISR_END(irq)            OS_Trace_Record(OS_TRACE_ISR_EXIT, OS_TRACE_NO_TASK, (uint16)(irq))
+#define OS_TRACE_USER_EVENT(arg)         OS_Trace_Record(OS_TRACE_USER, OS_GetCurrentTask()->TraceId, (uint16)(arg))
+
+#else
+
+#define OS_TRACE_EVENT(type, task, arg)
+#define OS_TRACE_ISR_BEGIN(irq)
+#define OS_TRACE_ISR_END(irq)
+#define OS_TRACE_USER_EVENT(arg)
+
+#endif
+
+#endif
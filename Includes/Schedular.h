@@ -0,0 +1,5 @@
+/*
+ * Kernel API under the name the sources include; the declarations live in OS.h.
+ */
+
+#include "OS.h"
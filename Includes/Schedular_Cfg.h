@@ -0,0 +1,5 @@
+/*
+ * Kernel configuration under the name OS.h includes; the settings live in OS_Cfg.h.
+ */
+
+#include "OS_Cfg.h"
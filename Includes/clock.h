@@ -0,0 +1,77 @@
+/****************************************************************************************************/
+/* Module Name : clock ( header file )                                                              */
+/*                                                                                                  */
+/* Author      : Team 1                                                                             */
+/*                                                                                                  */
+/* Purpose     : This header file declares the system clock configuration of the                    */
+/*               TM4C123GH6PM: the PLL driven from the 16 MHz main oscillator, and                  */
+/*               SystemCoreClock, the core frequency that SysTick, the kernel cycle                 */
+/*               counter and the UART baud rates derive from.                                       */
+/*                                                                                                  */
+/****************************************************************************************************/
+
+
+
+#ifndef _CLOCK_H
+#define _CLOCK_H
+
+#include "types.h"
+
+#define CLOCK_XTAL_HZ           16000000U    /* Main oscillator crystal (EK-TM4C123GXL) */
+#define CLOCK_PLL_HZ            400000000U   /* PLL output, divided by SYSDIV2 + 1 */
+#define CLOCK_MAX_HZ            80000000U
+#define CLOCK_MIN_HZ            (CLOCK_PLL_HZ / 128U)
+
+#ifndef CLOCK_SYSTEM_HZ
+#define CLOCK_SYSTEM_HZ         80000000U    /* Core clock set up by Clock_Init */
+#endif
+
+#define CLOCK_OK                0U
+#define CLOCK_INVALID           1U
+
+
+/****************************************Functions Prototype******************************************/
+
+
+/****************************************************************************************************/
+/* Function Name :  Clock_Init                                                                      */
+/* Inputs        :  void ( No inputs  )                                                             */
+/* Outputs       :  void ( No outputs )                                                             */
+/* Reentrancy    :  Non Reentrant                                                                   */
+/* Synchronous   :  Synchronous                                                                     */
+/* Description   :  This function sets the system clock to CLOCK_SYSTEM_HZ. It is called by         */
+/*                  OS_Port_Init before anything reads SystemCoreClock.                             */
+/****************************************************************************************************/
+void Clock_Init(void);
+
+
+
+/****************************************************************************************************/
+/* Function Name :  Clock_Set                                                                       */
+/* Inputs        :  uint32 ( frequency_hz )                                                         */
+/* Outputs       :  uint8  ( CLOCK_OK / CLOCK_INVALID )                                             */
+/* Reentrancy    :  Non Reentrant                                                                   */
+/* Synchronous   :  Synchronous                                                                     */
+/* Description   :  This function runs the core at frequency_hz: CLOCK_XTAL_HZ straight from        */
+/*                  the main oscillator, otherwise from the PLL at the fastest 400 MHz / n not      */
+/*                  above frequency_hz, between CLOCK_MIN_HZ and CLOCK_MAX_HZ. SystemCoreClock      */
+/*                  is updated and a running SysTick is reloaded for the same period at the new     */
+/*                  clock, the period in progress rescaled so it keeps its phase. Privileged code   */
+/*                  only: main, handlers or OS_PRIVILEGED_TASKS.                                    */
+/*                  A running OS_TRACE should be restarted after a change (OS_Trace.h).             */
+/****************************************************************************************************/
+uint8 Clock_Set(uint32 frequency_hz);
+
+
+
+/****************************************************************************************************/
+/* Function Name :  Clock_Get                                                                       */
+/* Inputs        :  void   ( No inputs  )                                                           */
+/* Outputs       :  uint32 ( SystemCoreClock )                                                      */
+/* Reentrancy    :  Reentrant                                                                       */
+/* Synchronous   :  Synchronous                                                                     */
+/* Description   :  This function returns the current core clock frequency in Hz.                   */
+/****************************************************************************************************/
+uint32 Clock_Get(void);
+
+#endif
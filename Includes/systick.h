@@ -16,7 +16,14 @@
 #ifndef _SYSTICK_H
 #define _SYSTICK_H
 
+#include <stdint.h>
 #include "types.h"
+#include "system_ARMCM4.h"
+
+/* SysTick runs from the core clock: counts per ms and the longest period the 24-bit reload
+   register can hold follow SystemCoreClock (clock.h) */
+#define SYSTICK_COUNTS_PER_MS   (SystemCoreClock / 1000U)
+#define SYSTICK_MAX_PERIOD_MS   (0xFFFFFFU / SYSTICK_COUNTS_PER_MS)
 
 
 /****************************************Functions Prototype******************************************/
@@ -58,7 +65,7 @@ void SysTick_Enable(void);
 /* Reentrancy    :  Reentrant																		 */
 /* Synchronous   :  Synchronous																		 */
 /* Description   :	This function calculates and returns the elapsed time in milliseconds by dividing*/ 
-/* 					the current value of the SysTick timer by the assumed clock frequency (16000 Hz) */
+/* 					the current value of the SysTick timer by the counts per millisecond              */
 /*****************************************************************************************************/
 uint32 SysTick_Period_Get(void);
 
@@ -129,7 +136,7 @@ void SysTick_Delay(uint32 n);
 /* Description   :	This function utilizes the SysTick_Delay function to implement a delay of the	 */
 /*					specified duration in milliseconds. It loops 'delay' times, each time invoking   */
 /*					SysTick_Delay with a parameter equivalent to 1 millisecond  					 */
-/*					(16000 SysTick timer ticks).											     	 */
+/*					(SYSTICK_COUNTS_PER_MS counts).											     	 */
 /*****************************************************************************************************/
 void SysTick_1ms (uint32 delay);
 
@@ -142,7 +149,7 @@ void SysTick_1ms (uint32 delay);
 /* Synchronous   :  Asynchronous																	 */
 /* Description   :	This function configures the SysTick timer by clearing control bits, reloading	 */
 /*					the timer, and setting the initial value. The reload value is set to achieve     */
-/*					a 1 ms period based on the assumption that the CPU frequency is 16 MHz.          */
+/*					a 1 ms period from the core clock published in SystemCoreClock.                  */
 /*					The function then enables the SysTick timer and sets its priority level.		 */			  
 /*****************************************************************************************************/
 void Systick_Start(void);
@@ -1,29 +1,86 @@
 #include "Schedular.h"
-#include "MY_RTOS_FIFO.h"
+#include "OS_Trace.h"
 #include "string.h"
 
+#if OS_STATIC_TASKS
+void IDLETASK(void);
+
+OS_STATIC_STACK(OS_IdleStack, 300);
+
+Task_ref Idletask OS_STATIC_TASK_ATTRIBUTE = {
+  OS_STATIC_TASK_STACK(OS_IdleStack),
+  .StackSize = 300,
+  .Priority = 20,
+  .p_TaskEntry = IDLETASK,
+  .TimingWaiting.Blocking = BlockingDisabled,
+  .TimingWaiting.Ticks_Count = 0,
+  .TaskName = "IDLETASK"
+};
+#else
 Task_ref Idletask;
-Task_ref* temp;
+#endif
 
-extern uint32_t __INITIAL_SP;
-uint32* StackFrame;
-uint32 SVC_Number;
+#if OS_SOFTWARE_TIMERS
+#if OS_STATIC_TASKS
+void TIMERTASK(void);
 
-uint32 g_tick;
+OS_STATIC_STACK(OS_TimerStack, OS_TIMER_TASK_STACK);
+
+Task_ref TimerTask OS_STATIC_TASK_ATTRIBUTE = {
+  OS_STATIC_TASK_STACK(OS_TimerStack),
+  .StackSize = OS_TIMER_TASK_STACK,
+  .Priority = OS_TIMER_TASK_PRIORITY,
+  .p_TaskEntry = TIMERTASK,
+  .TimingWaiting.Blocking = BlockingDisabled,
+  .TimingWaiting.Ticks_Count = 0,
+  .TaskName = "TIMERTASK"
+};
+#else
+Task_ref TimerTask;
+#endif
+#endif
 
-FIFO_Buf_t Ready_QUEUE;
-Task_ref* Ready_QUEUE_FIFO[10];
+uint32 g_tick;
+static uint32 g_tickWraps;        /* High word of the 64-bit tick count */
 
 struct{
   
+  /* CurrentTask and NextTask must stay the first two members: PendSV_Handler uses offsets 0 and 4 */
+  Task_ref*     CurrentTask;
+  Task_ref*     NextTask;
+  
   Task_ref*      Tasks[TasksNo];
-  uint32*        _S_MSP_Task;
-  uint32*        _E_MSP_Task;
-  uint32*        _PSP_TaskLocator;
   uint32        ActiveTasksNo;
   Task_ref*     PreviousTask;
-  Task_ref*     CurrentTask;
-  Task_ref*     NextTask;
+  
+  /* One FIFO list per priority, bit (31 - prio) of ReadyBitmap set while the list is not empty */
+  Task_ref*     ReadyHead[OS_PRIORITY_LEVELS];
+  Task_ref*     ReadyTail[OS_PRIORITY_LEVELS];
+  uint32        ReadyBitmap;
+  
+#if OS_SCHEDULER_EDF
+  /* Ready tasks of OS_EDF_PRIORITY: binary min-heap on AbsoluteDeadline */
+  Task_ref*     EdfHeap[TasksNo];
+  uint32        EdfHeapSize;
+#endif
+  
+  /* Delay list sorted by wakeup tick, each entry holds the ticks after its predecessor */
+  Task_ref*     DelayHead;
+  
+#if OS_SOFTWARE_TIMERS
+  /* Active timers sorted the same way, expired ones queued FIFO for TIMERTASK */
+  SoftwareTimer* TimerHead;
+  SoftwareTimer* ExpiredHead;
+  SoftwareTimer* ExpiredTail;
+#endif
+  
+#if OS_RUNTIME_STATS
+  uint32        StatsStamp;             /* OS_PORT_CYCLES() of the last switch or window roll */
+  uint32        WindowStart;
+  uint32        WindowTicks;
+  uint32        WindowLength;           /* Cycles in the last complete window */
+  uint32        WindowNo;               /* Windows closed, brackets readers of the two above */
+#endif
   
   enum{
     OS_Suspended,
@@ -32,301 +89,1726 @@ struct{
   
 }OS_Control;
 
-void Update_SchedularTable(void){
+static void OS_ReadyInsert(Task_ref* Task);
+static void OS_ReadyRemove(Task_ref* Task);
+static void OS_TaskRelease(Task_ref* Task);
+static void OS_WaitWake(Task_ref* Task, uint8 Result);
+
+/* Unlink a task from the delay list, O(1): its remaining delta is handed to its successor */
+static void OS_DelayRemove(Task_ref* Task){
+  
+  if((Task->p_PrevDelay == NULL) && (OS_Control.DelayHead != Task)){
+    return;
+  }
+  
+  if(Task->p_NextDelay != NULL){
+    Task->p_NextDelay->DelayTicks += Task->DelayTicks;
+    Task->p_NextDelay->p_PrevDelay = Task->p_PrevDelay;
+  }
+  if(Task->p_PrevDelay != NULL){
+    Task->p_PrevDelay->p_NextDelay = Task->p_NextDelay;
+  }
+  else{
+    OS_Control.DelayHead = Task->p_NextDelay;
+  }
+  Task->p_NextDelay = NULL;
+  Task->p_PrevDelay = NULL;
+  Task->DelayTicks = 0;
+}
+
+/* Queue a task to be made ready Ticks ticks from now, O(number of delayed tasks) outside the tick ISR */
+static void OS_DelayInsert(Task_ref* Task, uint32 Ticks){
+  
+  Task_ref* pPrev = NULL;
+  Task_ref* pNext = OS_Control.DelayHead;
+  
+  OS_DelayRemove(Task);
+  
+  while((pNext != NULL) && (pNext->DelayTicks <= Ticks)){
+    Ticks -= pNext->DelayTicks;
+    pPrev = pNext;
+    pNext = pNext->p_NextDelay;
+  }
+  
+  Task->DelayTicks = Ticks;
+  Task->p_PrevDelay = pPrev;
+  Task->p_NextDelay = pNext;
+  if(pNext != NULL){
+    pNext->DelayTicks -= Ticks;
+    pNext->p_PrevDelay = Task;
+  }
+  if(pPrev != NULL){
+    pPrev->p_NextDelay = Task;
+  }
+  else{
+    OS_Control.DelayHead = Task;
+  }
+}
+
+/* Let Ticks ticks pass on the delay list and make every expired task ready.
+   Only the head is touched unless tasks actually expire. */
+static void OS_DelayAdvance(uint32 Ticks){
   
   Task_ref* pTask;
-  Task_ref* pNextTask;
-  Task_ref* temp;
-  Task_ref* dummy = NULL;
-  uint32 k = 0;
-  for(unsigned char i = 0; i < OS_Control.ActiveTasksNo - 1; i++ ){
-    for(unsigned char j = 0; j < OS_Control.ActiveTasksNo - i - 1; j++){
-      if(OS_Control.Tasks[j]->Priority > OS_Control.Tasks[j+1]->Priority ){
-        temp = OS_Control.Tasks[j];
-        OS_Control.Tasks[j] = OS_Control.Tasks[j+1];
-        OS_Control.Tasks[j+1] = temp;
-      }
+  
+  while((OS_Control.DelayHead != NULL) && (OS_Control.DelayHead->DelayTicks <= Ticks)){
+    pTask = OS_Control.DelayHead;
+    Ticks -= pTask->DelayTicks;
+    pTask->DelayTicks = 0;
+    OS_DelayRemove(pTask);
+    if(pTask->TaskState == Waiting){
+      OS_WaitWake(pTask, OS_WAIT_TIMEOUT);
     }
+    else{
+      OS_TaskRelease(pTask);
+    }
+  }
+  if(OS_Control.DelayHead != NULL){
+    OS_Control.DelayHead->DelayTicks -= Ticks;
   }
+}
+
+#if OS_SOFTWARE_TIMERS
+/* Unlink a timer from the active list, O(1) */
+static void OS_TimerRemove(SoftwareTimer* pTimer){
   
-  while(FIFO_dequeue(&Ready_QUEUE, &dummy) != FIFO_EMPTY);
-  while(k < OS_Control.ActiveTasksNo){
-    
-    pTask = OS_Control.Tasks[k];
-    pNextTask = OS_Control.Tasks[k+1];
+  if((pTimer->State & OS_TIMER_ACTIVE) == 0U){
+    return;
+  }
+  
+  if(pTimer->p_Next != NULL){
+    pTimer->p_Next->DeltaTicks += pTimer->DeltaTicks;
+    pTimer->p_Next->p_Prev = pTimer->p_Prev;
+  }
+  if(pTimer->p_Prev != NULL){
+    pTimer->p_Prev->p_Next = pTimer->p_Next;
+  }
+  else{
+    OS_Control.TimerHead = pTimer->p_Next;
+  }
+  pTimer->p_Next = NULL;
+  pTimer->p_Prev = NULL;
+  pTimer->State &= ~OS_TIMER_ACTIVE;
+}
+
+/* Arm a timer to expire Ticks ticks from now, O(number of active timers) */
+static void OS_TimerInsert(SoftwareTimer* pTimer, uint32 Ticks){
+  
+  SoftwareTimer* pPrev = NULL;
+  SoftwareTimer* pNext = OS_Control.TimerHead;
+  
+  OS_TimerRemove(pTimer);
+  
+  while((pNext != NULL) && (pNext->DeltaTicks <= Ticks)){
+    Ticks -= pNext->DeltaTicks;
+    pPrev = pNext;
+    pNext = pNext->p_Next;
+  }
+  
+  pTimer->DeltaTicks = Ticks;
+  pTimer->p_Prev = pPrev;
+  pTimer->p_Next = pNext;
+  if(pNext != NULL){
+    pNext->DeltaTicks -= Ticks;
+    pNext->p_Prev = pTimer;
+  }
+  if(pPrev != NULL){
+    pPrev->p_Next = pTimer;
+  }
+  else{
+    OS_Control.TimerHead = pTimer;
+  }
+  pTimer->State |= OS_TIMER_ACTIVE;
+}
+
+/* Let Ticks ticks pass on the active list: expired timers are queued for TIMERTASK and
+   periodic ones re-armed from their expiry tick, so they do not drift */
+static void OS_TimerAdvance(uint32 Ticks){
+  
+  SoftwareTimer* pTimer;
+  
+  while((OS_Control.TimerHead != NULL) && (OS_Control.TimerHead->DeltaTicks <= Ticks)){
+    pTimer = OS_Control.TimerHead;
+    Ticks -= pTimer->DeltaTicks;
+    pTimer->DeltaTicks = 0;
+    OS_TimerRemove(pTimer);
+    if(pTimer->Mode == OS_TIMER_PERIODIC){
+      OS_TimerInsert(pTimer, pTimer->Period);
+    }
     
-    if(pTask->TaskState != Suspended){
-      
-      if(pNextTask->TaskState == Suspended){
-        FIFO_enqueue(&Ready_QUEUE, pTask);
-        pTask->TaskState = Ready;
-        break;
-      }
-      if(pTask->Priority < pNextTask->Priority){
-        FIFO_enqueue(&Ready_QUEUE, pTask);
-        pTask->TaskState = Ready;
-        break;
+    pTimer->State |= OS_TIMER_DUE;
+    if((pTimer->State & OS_TIMER_QUEUED) == 0U){
+      pTimer->State |= OS_TIMER_QUEUED;
+      pTimer->p_NextExpired = NULL;
+      if(OS_Control.ExpiredTail != NULL){
+        OS_Control.ExpiredTail->p_NextExpired = pTimer;
       }
-      else if(pTask->Priority > pNextTask->Priority){
-        FIFO_enqueue(&Ready_QUEUE, pTask);
-        pTask->TaskState = Ready;
-        break;
-      }
-      else if (pTask->Priority == pNextTask->Priority){
-        FIFO_enqueue(&Ready_QUEUE, pTask);
-        pTask->TaskState = Ready;
+      else{
+        OS_Control.ExpiredHead = pTimer;
       }
+      OS_Control.ExpiredTail = pTimer;
     }
-    k++;
+    OS_ReadyInsert(&TimerTask);
+  }
+  if(OS_Control.TimerHead != NULL){
+    OS_Control.TimerHead->DeltaTicks -= Ticks;
   }
-  
 }
 
-void SVC_Handler(void){
+/* Next timer whose callback is due for TIMERTASK (in its WaitMessage); TIMERTASK is suspended
+   when there is none */
+static void OS_TimerNextExpired(void){
   
-  __asm("tst lr, #4   \n"
-        "ITE EQ         \n"
-          "mrseq r0, MSP  \n"
-            "mrsne r0, PSP  \n"
-              "mov %0, r0" : "=r" (StackFrame));
-  SVC_Number = *((uint8*)StackFrame[6] - 2);
+  SoftwareTimer* pTimer;
   
-  switch(SVC_Number){
-  case 0:
-  case 1:
-    Update_SchedularTable();
-    if(OS_Control.OS_STATE == Running){
-      if(strcmp(OS_Control.CurrentTask->TaskName, "IDLETASK") != 0){
-        //Decide what next
-        FIFO_dequeue(&Ready_QUEUE, &OS_Control.NextTask);
-        OS_Control.NextTask->TaskState = Running;
-        //Update ReadyQueue
-        if((OS_Control.CurrentTask->Priority == OS_Control.NextTask->Priority)&&(OS_Control.CurrentTask->TaskState != Suspended)){
-          FIFO_enqueue(&Ready_QUEUE, OS_Control.CurrentTask);
-          OS_Control.CurrentTask->TaskState = Ready;
-        }
-        //Trigger OS_PendSV
-        SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
-      }
+  OS_Control.CurrentTask->WaitMessage = NULL;
+  while(OS_Control.ExpiredHead != NULL){
+    pTimer = OS_Control.ExpiredHead;
+    OS_Control.ExpiredHead = pTimer->p_NextExpired;
+    if(OS_Control.ExpiredHead == NULL){
+      OS_Control.ExpiredTail = NULL;
+    }
+    pTimer->State &= ~OS_TIMER_QUEUED;
+    //Stopped after it expired: drop the callback
+    if((pTimer->State & OS_TIMER_DUE) != 0U){
+      pTimer->State &= ~OS_TIMER_DUE;
+      OS_Control.CurrentTask->WaitMessage = pTimer;
+      return;
     }
-  case 2:
-    Update_SchedularTable();
-    break;
   }
+  OS_ReadyRemove(OS_Control.CurrentTask);
 }
+#endif
 
-
-__attribute((naked))void PendSV_Handler(void){
+/* Ticks until the next TimingWaiting activation of a periodic task (when g_tick % Ticks_Count == 1) */
+static uint32 OS_PeriodDistance(Task_ref* Task){
+  
+  uint32 distance;
   
-  __asm("CPSID  I");
-  __asm volatile("mrs %0, PSP" :  "=r"(OS_Control.CurrentTask->Current_PSP));
+  distance = (Task->TimingWaiting.Ticks_Count + 1 - (g_tick % Task->TimingWaiting.Ticks_Count)) % Task->TimingWaiting.Ticks_Count;
+  if(distance == 0){
+    distance = Task->TimingWaiting.Ticks_Count;
+  }
+  return distance;
+}
+
+#if OS_SCHEDULER_EDF
+/* Deadlines compare modulo 2^32 so g_tick may wrap */
+static boolean OS_DeadlineBefore(const Task_ref* A, const Task_ref* B){
   
-  (OS_Control.CurrentTask->Current_PSP)--;
-  __asm volatile("mov %0, r4" : "=r" (*(OS_Control.CurrentTask->Current_PSP)));
-  (OS_Control.CurrentTask->Current_PSP)--;
-  __asm volatile("mov %0, r5" : "=r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP--;
-  __asm volatile("mov %0, r6" : "=r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP--;
-  __asm volatile("mov %0, r7" : "=r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP--;
-  __asm volatile("mov %0, r8" : "=r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP--;
-  __asm volatile("mov %0, r9" : "=r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP--;
-  __asm volatile("mov %0, r10" : "=r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP--;
-  __asm volatile("mov %0, r11" : "=r" (*(OS_Control.CurrentTask->Current_PSP)));
+  return ((int32)(A->AbsoluteDeadline - B->AbsoluteDeadline) < 0) ? TRUE : FALSE;
+}
+
+static void OS_EdfPlace(uint32 Index, Task_ref* Task){
   
-  OS_Control.CurrentTask = OS_Control.NextTask;
-  OS_Control.NextTask = NULL;
+  OS_Control.EdfHeap[Index] = Task;
+  Task->HeapIndex = Index;
+}
+
+static void OS_EdfSiftUp(uint32 Index){
   
-  __asm volatile("mov r11, %0" : : "r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP++;
-  __asm volatile("mov r10, %0" : : "r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP++;
-  __asm volatile("mov r9, %0" : : "r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP++;
-  __asm volatile("mov r8, %0" : : "r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP++;
-  __asm volatile("mov r7, %0" : : "r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP++;
-  __asm volatile("mov r6, %0" : : "r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP++;
-  __asm volatile("mov r5, %0" : : "r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP++;
-  __asm volatile("mov r4, %0" : : "r" (*(OS_Control.CurrentTask->Current_PSP)));
-  OS_Control.CurrentTask->Current_PSP++;
+  Task_ref* pTask = OS_Control.EdfHeap[Index];
+  uint32 parent;
   
+  while(Index > 0U){
+    parent = (Index - 1U) / 2U;
+    if(!OS_DeadlineBefore(pTask, OS_Control.EdfHeap[parent])){
+      break;
+    }
+    OS_EdfPlace(Index, OS_Control.EdfHeap[parent]);
+    Index = parent;
+  }
+  OS_EdfPlace(Index, pTask);
+}
+
+static void OS_EdfSiftDown(uint32 Index){
   
-  OS_SET_PSP(OS_Control.CurrentTask->Current_PSP);
-  __asm("CPSIE  I");
-  __asm volatile ("BX LR");
+  Task_ref* pTask = OS_Control.EdfHeap[Index];
+  uint32 child;
   
+  while((child = 2U * Index + 1U) < OS_Control.EdfHeapSize){
+    if(((child + 1U) < OS_Control.EdfHeapSize) && OS_DeadlineBefore(OS_Control.EdfHeap[child + 1U], OS_Control.EdfHeap[child])){
+      child++;
+    }
+    if(!OS_DeadlineBefore(OS_Control.EdfHeap[child], pTask)){
+      break;
+    }
+    OS_EdfPlace(Index, OS_Control.EdfHeap[child]);
+    Index = child;
+  }
+  OS_EdfPlace(Index, pTask);
 }
 
+/* O(log n) insert/remove, the earliest deadline is always EdfHeap[0] */
+static void OS_EdfInsert(Task_ref* Task){
+  
+  OS_EdfPlace(OS_Control.EdfHeapSize, Task);
+  OS_Control.EdfHeapSize++;
+  OS_EdfSiftUp(Task->HeapIndex);
+  OS_Control.ReadyBitmap |= OS_PRIORITY_BIT(OS_EDF_PRIORITY);
+}
 
-void IDLETASK(void){
+static void OS_EdfRemove(Task_ref* Task){
   
-  while(1){
-    __asm("wfe");
+  uint32 index = Task->HeapIndex;
+  Task_ref* pLast;
+  
+  OS_Control.EdfHeapSize--;
+  if(index != OS_Control.EdfHeapSize){
+    //Fill the hole with the last entry and restore the order in whichever direction it breaks
+    pLast = OS_Control.EdfHeap[OS_Control.EdfHeapSize];
+    OS_EdfPlace(index, pLast);
+    OS_EdfSiftUp(index);
+    OS_EdfSiftDown(pLast->HeapIndex);
+  }
+  if(OS_Control.EdfHeapSize == 0U){
+    OS_Control.ReadyBitmap &= ~OS_PRIORITY_BIT(OS_EDF_PRIORITY);
   }
 }
+#endif
 
+/* Give a task a full round-robin quantum */
+static void OS_SliceReload(Task_ref* Task){
+  
+  Task->SliceTicks = (Task->TimeSlice != 0U) ? Task->TimeSlice : OS_TIME_SLICE;
+}
 
-
-void OS_Init(void){
+/* Append a task to the tail of its priority list, O(1). Waiting tasks are only released by the
+   object they wait on (or their timeout). */
+static void OS_ReadyInsert(Task_ref* Task){
   
-  OS_Control._S_MSP_Task = &__INITIAL_SP;
-  OS_Control._E_MSP_Task = (uint32*)((((uint32)OS_Control._S_MSP_Task - 1000)/8)*8);
-  OS_Control._PSP_TaskLocator = (uint32*)((((uint32)OS_Control._E_MSP_Task - 8)/8)*8);
+  uint8 prio = Task->Priority;
   
-  FIFO_init(&Ready_QUEUE, Ready_QUEUE_FIFO, 10);
+  if(Task->TaskState != Suspended){
+    return;
+  }
+  OS_DelayRemove(Task);
+  OS_TRACE_EVENT(OS_TRACE_READY, Task, 0);
+  OS_SliceReload(Task);
   
-  Idletask.StackSize = 300;
-  Idletask.Priority = 20;
-  Idletask.p_TaskEntry = IDLETASK;
-  Idletask.TimingWaiting.Blocking = BlockingDisabled;
-  Idletask.TimingWaiting.Ticks_Count = 0;
-  strcpy(Idletask.TaskName, "IDLETASK");
-  OS_CreateTask(&Idletask);
+#if OS_SCHEDULER_EDF
+  if(prio == OS_EDF_PRIORITY){
+    OS_EdfInsert(Task);
+    Task->TaskState = Ready;
+    return;
+  }
+#endif
   
-  //NVIC_SetPriority(SysTick_IRQn, 0U);
-  *(uint32_t volatile *)0xE000ED20 |= (0xFFU << 16);
+  Task->p_NextReady = NULL;
+  Task->p_PrevReady = OS_Control.ReadyTail[prio];
+  if(OS_Control.ReadyTail[prio] != NULL){
+    OS_Control.ReadyTail[prio]->p_NextReady = Task;
+  }
+  else{
+    OS_Control.ReadyHead[prio] = Task;
+    OS_Control.ReadyBitmap |= OS_PRIORITY_BIT(prio);
+  }
+  OS_Control.ReadyTail[prio] = Task;
+  Task->TaskState = Ready;
 }
 
-
-void OS_CreateTask(Task_ref* Task){
-  
-  Task->_S_PSP_Task = OS_Control._PSP_TaskLocator;
-  Task->_E_PSP_Task = (uint32*)((((uint32)(Task->_S_PSP_Task) - Task->StackSize)/8)*8);
-  OS_Control._PSP_TaskLocator = Task->_E_PSP_Task - 30;
+/* Unlink a task from its priority list, O(1) */
+static void OS_ReadyRemove(Task_ref* Task){
   
-  /**Create Task Stack**/
-  Task->Current_PSP = Task->_S_PSP_Task;
+  uint8 prio = Task->Priority;
   
-  Task->Current_PSP--;                       //XPSR
-  *(Task->Current_PSP) &= 0x0;
-  *(Task->Current_PSP) = 0x01000000;                            
+  if((Task->TaskState != Ready) && (Task->TaskState != Running)){
+    return;
+  }
   
-  Task->Current_PSP--;                       //PC
-  *(Task->Current_PSP) &= 0x0;
-  *(Task->Current_PSP) = (uint32)(Task->p_TaskEntry);          
+#if OS_SCHEDULER_EDF
+  if(prio == OS_EDF_PRIORITY){
+    OS_EdfRemove(Task);
+    Task->TaskState = Suspended;
+    return;
+  }
+#endif
   
-  Task->Current_PSP--;                       //LR
-  *(Task->Current_PSP) = 0x0;
-  *(Task->Current_PSP) = 0xFFFFFFFD;         //Return to Thread with PSP  
+  if(Task->p_PrevReady != NULL){
+    Task->p_PrevReady->p_NextReady = Task->p_NextReady;
+  }
+  else{
+    OS_Control.ReadyHead[prio] = Task->p_NextReady;
+  }
+  if(Task->p_NextReady != NULL){
+    Task->p_NextReady->p_PrevReady = Task->p_PrevReady;
+  }
+  else{
+    OS_Control.ReadyTail[prio] = Task->p_PrevReady;
+  }
+  if(OS_Control.ReadyHead[prio] == NULL){
+    OS_Control.ReadyBitmap &= ~OS_PRIORITY_BIT(prio);
+  }
+  Task->p_NextReady = NULL;
+  Task->p_PrevReady = NULL;
+  Task->TaskState = Suspended;
+}
+
+/* A new activation of a task becomes ready; under EDF its absolute deadline starts now */
+static void OS_TaskRelease(Task_ref* Task){
   
-  for(uint8 i = 0; i < 13; i++){              //R0 - R12
-    Task->Current_PSP--;                                         
-    *(Task->Current_PSP) = 0x0;
+#if OS_SCHEDULER_EDF
+  if(Task->TaskState == Suspended){
+    Task->AbsoluteDeadline = g_tick + ((Task->RelativeDeadline != 0U) ? Task->RelativeDeadline : Task->TimingWaiting.Ticks_Count);
   }
+#endif
+  OS_ReadyInsert(Task);
+}
+
+/* Suspend a task, periodic tasks are queued for their next activation */
+static void OS_TaskHold(Task_ref* Task){
   
-  OS_Control.Tasks[OS_Control.ActiveTasksNo] = Task;
-  OS_Control.ActiveTasksNo++;
+  if(Task->TaskState == Waiting){
+    return;
+  }
+  OS_ReadyRemove(Task);
+  if((Task->TimingWaiting.Blocking == BlockingEnabled) && (Task->TimingWaiting.Ticks_Count > 1)){
+    OS_DelayInsert(Task, OS_PeriodDistance(Task));
+  }
+}
+
+/* Highest ready priority: its list head, or the earliest deadline in the EDF band */
+static Task_ref* OS_ReadyFirst(void){
   
-  Task->TaskState = Suspended;
-  OS_ActivateTask(Task);
+  uint32 prio = OS_PORT_CLZ(OS_Control.ReadyBitmap);
   
+#if OS_SCHEDULER_EDF
+  if(prio == OS_EDF_PRIORITY){
+    return OS_Control.EdfHeap[0];
+  }
+#endif
+  return OS_Control.ReadyHead[prio];
 }
 
-void OS_ActivateTask(Task_ref* Task){
+/* Move the head of a priority list to its tail (round robin between equal priorities) */
+static void OS_ReadyRotate(uint8 prio){
   
-  Task->TaskState = Waiting;
-  /**Trigger SVC**/
-  __asm("svc #0x00");
+  Task_ref* pHead = OS_Control.ReadyHead[prio];
   
+  if((pHead == NULL) || (pHead->p_NextReady == NULL)){
+    return;
+  }
+  OS_Control.ReadyHead[prio] = pHead->p_NextReady;
+  OS_Control.ReadyHead[prio]->p_PrevReady = NULL;
+  pHead->p_PrevReady = OS_Control.ReadyTail[prio];
+  pHead->p_NextReady = NULL;
+  OS_Control.ReadyTail[prio]->p_NextReady = pHead;
+  OS_Control.ReadyTail[prio] = pHead;
 }
 
+/* Insert a blocked task into a wait list ordered by priority, FIFO among equal priorities.
+   Only the waiters of that object are walked; releasing the head is O(1). */
+static void OS_WaitListInsert(Task_ref** pHead, Task_ref* Task){
+  
+  Task_ref* pPrev = NULL;
+  Task_ref* pNext = *pHead;
+  
+  while((pNext != NULL) && (pNext->Priority <= Task->Priority)){
+    pPrev = pNext;
+    pNext = pNext->p_NextReady;
+  }
+  
+  Task->p_PrevReady = pPrev;
+  Task->p_NextReady = pNext;
+  if(pNext != NULL){
+    pNext->p_PrevReady = Task;
+  }
+  if(pPrev != NULL){
+    pPrev->p_NextReady = Task;
+  }
+  else{
+    *pHead = Task;
+  }
+  Task->p_WaitList = pHead;
+}
 
-void OS_TerminateTask(Task_ref* Task){
+static void OS_WaitListRemove(Task_ref* Task){
   
-  Task->TaskState = Suspended;
-  /**Trigger SVC**/
-  __asm("svc #0x01");
+  if(Task->p_PrevReady != NULL){
+    Task->p_PrevReady->p_NextReady = Task->p_NextReady;
+  }
+  else{
+    *Task->p_WaitList = Task->p_NextReady;
+  }
+  if(Task->p_NextReady != NULL){
+    Task->p_NextReady->p_PrevReady = Task->p_PrevReady;
+  }
+  Task->p_NextReady = NULL;
+  Task->p_PrevReady = NULL;
+  Task->p_WaitList = NULL;
 }
 
+/* Block the running task on a wait list, Timeout ticks at most unless OS_WAIT_FOREVER */
+static void OS_WaitBlock(Task_ref** pHead, uint32 Timeout){
+  
+  Task_ref* pTask = OS_Control.CurrentTask;
+  
+  OS_ReadyRemove(pTask);
+  pTask->TaskState = Waiting;
+  OS_WaitListInsert(pHead, pTask);
+  if(Timeout != OS_WAIT_FOREVER){
+    OS_DelayInsert(pTask, Timeout);
+  }
+}
 
-void OS_HoldTask(Task_ref* Task){
+/* End the wait of a blocked task, from the object it waits on or from its timeout */
+static void OS_WaitWake(Task_ref* Task, uint8 Result){
   
+  OS_WaitListRemove(Task);
+  Task->WaitResult = Result;
   Task->TaskState = Suspended;
-  /**Trigger SVC**/
-  __asm("svc #0x01");
+  OS_ReadyInsert(Task);
+}
+
+/* Change the effective priority of a task, keeping the list it sits in ordered */
+static void OS_SetPriority(Task_ref* Task, uint8 Priority){
+  
+  uint8 state = Task->TaskState;
+  
+  if(Task->Priority == Priority){
+    return;
+  }
   
+  if((state == Ready) || (state == Running)){
+    OS_ReadyRemove(Task);
+    Task->Priority = Priority;
+    OS_ReadyInsert(Task);
+    Task->TaskState = state;
+  }
+  else if(Task->p_WaitList != NULL){
+    Task_ref** pHead = Task->p_WaitList;
+    
+    OS_WaitListRemove(Task);
+    Task->Priority = Priority;
+    OS_WaitListInsert(pHead, Task);
+  }
+  else{
+    Task->Priority = Priority;
+  }
 }
-uint32 OS_GetTime(void){
+
+/* Base priority raised to the highest task still waiting on any mutex the task owns */
+static uint8 OS_InheritedPriority(Task_ref* Task){
   
-  return g_tick;
+  uint8 prio = Task->BasePriority;
+  Mutex* pMutex;
   
+  for(pMutex = Task->p_HeldMutexes; pMutex != NULL; pMutex = pMutex->p_NextHeld){
+    if((pMutex->p_WaitHead != NULL) && (pMutex->p_WaitHead->Priority < prio)){
+      prio = pMutex->p_WaitHead->Priority;
+    }
+  }
+  return prio;
 }
 
-void OS_Start(void){
+static void OS_MutexAcquire(Mutex* pMutex, Task_ref* Task){
   
-  OS_Control.OS_STATE = Running;
+  pMutex->Owner = Task;
+  pMutex->LockCount = 1;
+  pMutex->p_NextHeld = Task->p_HeldMutexes;
+  Task->p_HeldMutexes = pMutex;
+}
+
+static void OS_MutexLock(Mutex* pMutex){
   
-  OS_Control.CurrentTask = &Idletask;
-  // OS_Control.NextTask = OS_Control.Tasks[1];
-  Systick_Start();
+  Task_ref* pTask = OS_Control.CurrentTask;
+  Task_ref* pOwner = pMutex->Owner;
   
-  OS_ActivateTask(&Idletask);
+  if(pOwner == NULL){
+    OS_MutexAcquire(pMutex, pTask);
+    return;
+  }
+  if(pOwner == pTask){
+    pMutex->LockCount++;
+    return;
+  }
   
-  OS_SET_PSP(OS_Control.CurrentTask->Current_PSP);
-  OS_SET_SP_TO_PSP;
-  CPUAccess_Unprivileged;
-  OS_Control.CurrentTask->p_TaskEntry();
+  //Block, then lend our priority down the chain of owners
+  pTask->p_WaitingMutex = pMutex;
+  OS_WaitBlock(&pMutex->p_WaitHead, OS_WAIT_FOREVER);
   
+  while((pOwner != NULL) && (pTask->Priority < pOwner->Priority)){
+    OS_SetPriority(pOwner, pTask->Priority);
+    pOwner = (pOwner->p_WaitingMutex != NULL) ? pOwner->p_WaitingMutex->Owner : NULL;
+  }
 }
 
-void SysTick_Handler(void){
-  g_tick++;
+static void OS_MutexUnlock(Mutex* pMutex){
   
-  for(uint8 i = 0; i < TasksNo; i++){
-    if(OS_Control.Tasks[i]->TaskState == Suspended){
-      if(OS_Control.Tasks[i]->TimingWaiting.Blocking == BlockingEnabled){
-        if(g_tick % OS_Control.Tasks[i]->TimingWaiting.Ticks_Count - 1 == 0){
-          OS_Control.Tasks[i]->TaskState = Waiting;
-          Update_SchedularTable();
-        }   
-      }
+  Task_ref* pTask = OS_Control.CurrentTask;
+  Task_ref* pWaiter;
+  Mutex** ppHeld;
+  
+  if((pMutex->Owner != pTask) || (--pMutex->LockCount != 0)){
+    return;
+  }
+  
+  for(ppHeld = &pTask->p_HeldMutexes; *ppHeld != NULL; ppHeld = &(*ppHeld)->p_NextHeld){
+    if(*ppHeld == pMutex){
+      *ppHeld = pMutex->p_NextHeld;
+      break;
     }
   }
-  if(Ready_QUEUE.counter == 0 && OS_Control.CurrentTask->TaskState != Suspended){
-    OS_Control.CurrentTask->TaskState = Running;
-    FIFO_enqueue(&Ready_QUEUE, OS_Control.CurrentTask);
-    OS_Control.NextTask = OS_Control.CurrentTask;
+  pMutex->p_NextHeld = NULL;
+  OS_SetPriority(pTask, OS_InheritedPriority(pTask));
+  
+  //Hand the mutex straight to the highest-priority waiter
+  pWaiter = pMutex->p_WaitHead;
+  if(pWaiter != NULL){
+    pWaiter->p_WaitingMutex = NULL;
+    OS_MutexAcquire(pMutex, pWaiter);
+    OS_WaitWake(pWaiter, OS_WAIT_OK);
+  }
+  else{
+    pMutex->Owner = NULL;
   }
+}
+
+static void OS_CountingSemaphoreTake(CountingSemaphore* pSemaphore, uint32 Timeout){
+  
+  Task_ref* pTask = OS_Control.CurrentTask;
   
+  OS_TRACE_EVENT(OS_TRACE_SEM_TAKE, pTask, (uintptr_t)pSemaphore);
+  if(pSemaphore->Count != 0){
+    pSemaphore->Count--;
+    pTask->WaitResult = OS_WAIT_OK;
+  }
+  else if(Timeout == OS_NO_WAIT){
+    pTask->WaitResult = OS_WAIT_TIMEOUT;
+  }
   else{
-    FIFO_dequeue(&Ready_QUEUE, &OS_Control.NextTask);
-    OS_Control.NextTask->TaskState = Running;
-    if((OS_Control.CurrentTask->Priority == OS_Control.NextTask->Priority)&&(OS_Control.CurrentTask->TaskState != Suspended)){
-      FIFO_enqueue(&Ready_QUEUE, OS_Control.CurrentTask);
-      OS_Control.CurrentTask->TaskState = Ready;
-    }
+    OS_TRACE_EVENT(OS_TRACE_SEM_BLOCK, pTask, (uintptr_t)pSemaphore);
+    OS_WaitBlock(&pSemaphore->p_WaitHead, Timeout);
   }
-  SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
 }
 
+/* A give with waiters hands the unit straight to the highest-priority one */
+static void OS_CountingSemaphoreGive(CountingSemaphore* pSemaphore){
+  
+  OS_TRACE_EVENT(OS_TRACE_SEM_GIVE, OS_Control.CurrentTask, (uintptr_t)pSemaphore);
+  if(pSemaphore->p_WaitHead != NULL){
+    OS_WaitWake(pSemaphore->p_WaitHead, OS_WAIT_OK);
+  }
+  else{
+    pSemaphore->Count++;
+  }
+}
 
-void SemaphoreTake(BinarySemaphore* Semaphore, Task_ref* task){
+/* Binary semaphore: the taking task is parked until a give, the check, the handoff and the
+   suspend run as one kernel call so a give from an interrupt cannot fall in between */
+static void OS_BinarySemaphoreTake(BinarySemaphore* Semaphore, Task_ref* Task){
   
   if(Semaphore->NextTask == NULL){
-    Semaphore->NextTask = task;
-    task->TaskState = Suspended;
-    __asm("svc #0x01");
+    Semaphore->NextTask = Task;
+    OS_TaskHold(Task);
   }
-  else{
-    /*ytl3 error aw haga 3shan mynf3sh aktar mn task yakhdo nfs el binary semaphore*/
+}
+
+static void OS_BinarySemaphoreGive(BinarySemaphore* Semaphore){
+  
+  if(Semaphore->NextTask != NULL){
+    Semaphore->CurrentTask = Semaphore->NextTask;
+    Semaphore->NextTask = NULL;
+    OS_TaskRelease(Semaphore->CurrentTask);
+  }
+}
+
+/* Queue a message, handing it straight to a waiting receiver; OS_WAIT_TIMEOUT when full */
+static uint8 OS_QueuePut(MessageQueue* pQueue, void* Message){
+  
+  Task_ref* pReceiver = pQueue->p_ReceiveWaitHead;
+  uint32 tail;
+  
+  if(pReceiver != NULL){
+    pReceiver->WaitMessage = Message;
+    OS_WaitWake(pReceiver, OS_WAIT_OK);
+    return OS_WAIT_OK;
+  }
+  if(pQueue->Count == pQueue->Length){
+    return OS_WAIT_TIMEOUT;
+  }
+  
+  tail = pQueue->Head + pQueue->Count;
+  if(tail >= pQueue->Length){
+    tail -= pQueue->Length;
+  }
+  pQueue->Buffer[tail] = Message;
+  pQueue->Count++;
+  return OS_WAIT_OK;
+}
+
+/* Dequeue the oldest message and let the highest-priority blocked sender refill the slot;
+   OS_WAIT_TIMEOUT when empty */
+static uint8 OS_QueueGet(MessageQueue* pQueue, void** pMessage){
+  
+  Task_ref* pSender;
+  
+  if(pQueue->Count == 0){
+    return OS_WAIT_TIMEOUT;
   }
   
+  *pMessage = pQueue->Buffer[pQueue->Head];
+  pQueue->Head++;
+  if(pQueue->Head == pQueue->Length){
+    pQueue->Head = 0;
+  }
+  pQueue->Count--;
+  
+  pSender = pQueue->p_SendWaitHead;
+  if(pSender != NULL){
+    (void)OS_QueuePut(pQueue, pSender->WaitMessage);
+    OS_WaitWake(pSender, OS_WAIT_OK);
+  }
+  return OS_WAIT_OK;
 }
 
+/* The message to send is left in the caller's WaitMessage by MessageQueueSend */
+static void OS_MessageQueueSend(MessageQueue* pQueue, uint32 Timeout){
+  
+  Task_ref* pTask = OS_Control.CurrentTask;
+  
+  pTask->WaitResult = OS_QueuePut(pQueue, pTask->WaitMessage);
+  if((pTask->WaitResult != OS_WAIT_OK) && (Timeout != OS_NO_WAIT)){
+    OS_WaitBlock(&pQueue->p_SendWaitHead, Timeout);
+  }
+}
 
-void SemaphoreGive(BinarySemaphore* Semaphore){
+/* The message received is returned in the caller's WaitMessage */
+static void OS_MessageQueueReceive(MessageQueue* pQueue, uint32 Timeout){
+  
+  Task_ref* pTask = OS_Control.CurrentTask;
+  
+  pTask->WaitResult = OS_QueueGet(pQueue, &pTask->WaitMessage);
+  if((pTask->WaitResult != OS_WAIT_OK) && (Timeout != OS_NO_WAIT)){
+    OS_WaitBlock(&pQueue->p_ReceiveWaitHead, Timeout);
+  }
+}
+
+/* The group's flags satisfy the any/all wait of Task */
+static boolean OS_EventSatisfied(const EventGroup* pGroup, const Task_ref* Task){
+  
+  uint32 matched = pGroup->Flags & Task->WaitFlags;
+  
+  return ((Task->WaitOptions & OS_EVENT_WAIT_ALL) != 0U) ? (matched == Task->WaitFlags) : (matched != 0U);
+}
+
+/* End a satisfied wait: WaitFlags gets the group's flags, returns the flags the task consumes */
+static uint32 OS_EventConsume(const EventGroup* pGroup, Task_ref* Task){
+  
+  uint32 clear = ((Task->WaitOptions & OS_EVENT_CLEAR) != 0U) ? (pGroup->Flags & Task->WaitFlags) : 0U;
+  
+  Task->WaitFlags = pGroup->Flags;
+  return clear;
+}
+
+/* Set flags and release every waiter they satisfy, highest priority first. Flags consumed by
+   OS_EVENT_CLEAR waiters are cleared once every waiter has seen them. */
+static void OS_EventSet(EventGroup* pGroup, uint32 Flags){
+  
+  Task_ref* pTask = pGroup->p_WaitHead;
+  Task_ref* pNext;
+  uint32 clear = 0U;
+  
+  pGroup->Flags |= Flags;
+  while(pTask != NULL){
+    pNext = pTask->p_NextReady;
+    if(OS_EventSatisfied(pGroup, pTask)){
+      clear |= OS_EventConsume(pGroup, pTask);
+      OS_WaitWake(pTask, OS_WAIT_OK);
+    }
+    pTask = pNext;
+  }
+  pGroup->Flags &= ~clear;
+}
+
+/* Flags and options are left in the caller's WaitFlags/WaitOptions by EventGroupWait */
+static void OS_EventWait(EventGroup* pGroup, uint32 Timeout){
+  
+  Task_ref* pTask = OS_Control.CurrentTask;
   
-  Semaphore->CurrentTask = Semaphore->NextTask ;
-  Semaphore->NextTask = NULL;
-  Semaphore->CurrentTask->TaskState = Waiting;
-  __asm("svc #0x00");
+  if(OS_EventSatisfied(pGroup, pTask)){
+    pGroup->Flags &= ~OS_EventConsume(pGroup, pTask);
+    pTask->WaitResult = OS_WAIT_OK;
+  }
+  else if(Timeout == OS_NO_WAIT){
+    pTask->WaitResult = OS_WAIT_TIMEOUT;
+  }
+  else{
+    OS_WaitBlock(&pGroup->p_WaitHead, Timeout);
+  }
+}
+
+/* Hand the pending notification to its task: value in WaitFlags, the bits asked for cleared */
+static void OS_NotifyConsume(Task_ref* Task, uint32 ClearOnExit){
+  
+  Task->WaitFlags = Task->NotifyValue;
+  Task->NotifyValue &= ~ClearOnExit;
+  Task->NotifyPending = FALSE;
+}
+
+/* O(1) both ways: update the value and, if the task is blocked on it, wake it straight away */
+static void OS_Notify(Task_ref* Task, uint8 Action, uint32 Value){
+  
+  if(Action == OS_NOTIFY_SET_BITS){
+    Task->NotifyValue |= Value;
+  }
+  else if(Action == OS_NOTIFY_INCREMENT){
+    Task->NotifyValue++;
+  }
+  else{
+    Task->NotifyValue = Value;
+  }
+  Task->NotifyPending = TRUE;
+  
+  if(Task->p_NotifyWaiter != NULL){
+    //WaitFlags holds the ClearOnExit mask of the blocked call
+    OS_NotifyConsume(Task, Task->WaitFlags);
+    OS_WaitWake(Task, OS_WAIT_OK);
+  }
+}
+
+static void OS_NotifyWait(uint32 ClearOnExit, uint32 Timeout){
+  
+  Task_ref* pTask = OS_Control.CurrentTask;
+  
+  if(pTask->NotifyPending){
+    OS_NotifyConsume(pTask, ClearOnExit);
+    pTask->WaitResult = OS_WAIT_OK;
+  }
+  else if(Timeout == OS_NO_WAIT){
+    pTask->WaitResult = OS_WAIT_TIMEOUT;
+  }
+  else{
+    pTask->WaitFlags = ClearOnExit;
+    OS_WaitBlock(&pTask->p_NotifyWaiter, Timeout);
+  }
+}
+
+/* Pop the free-list head, O(1); NULL when the pool is exhausted */
+static void* OS_MemPoolTake(MemPool* pPool){
+  
+  uintptr_t* pBlock = pPool->p_FreeHead;
+  
+  if(pBlock == NULL){
+#if OS_MEMPOOL_STATS
+    pPool->FailedNo++;
+#endif
+    return NULL;
+  }
+  pPool->p_FreeHead = (uintptr_t*)pBlock[0];
+  pBlock[1] = 0;
+  
+#if OS_MEMPOOL_STATS
+  pPool->UsedNo++;
+  if(pPool->UsedNo > pPool->PeakUsedNo){
+    pPool->PeakUsedNo = pPool->UsedNo;
+  }
+#endif
+  return pBlock;
+}
+
+/* Whether pBlock is on the free list, walked only to confirm a free marker */
+static boolean OS_MemPoolIsFree(const MemPool* pPool, const uintptr_t* pBlock){
+  
+  for(const uintptr_t* pFree = pPool->p_FreeHead; pFree != NULL; pFree = (const uintptr_t*)pFree[0]){
+    if(pFree == pBlock){
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/* Push a block back, O(1). Blocks outside the pool, not on a block boundary or already free are
+   refused. The free marker is only a hint: user data can hold the same word, so a block carrying
+   it is refused only once the free list confirms it. */
+static uint8 OS_MemPoolPut(MemPool* pPool, void* Block){
+  
+  uintptr_t* pBlock = Block;
+  
+  if(((uint8*)Block < pPool->p_Start) || ((uint8*)Block >= pPool->p_End) ||
+     ((uint32)((uint8*)Block - pPool->p_Start) % pPool->BlockSize != 0) ||
+     ((pBlock[1] == OS_MEMPOOL_FREE_MARK(pBlock)) && OS_MemPoolIsFree(pPool, pBlock))){
+#if OS_MEMPOOL_STATS
+    pPool->InvalidFreeNo++;
+#endif
+    return OS_MEMPOOL_INVALID;
+  }
+  
+  pBlock[0] = (uintptr_t)pPool->p_FreeHead;
+  pBlock[1] = OS_MEMPOOL_FREE_MARK(pBlock);
+  pPool->p_FreeHead = pBlock;
+#if OS_MEMPOOL_STATS
+  pPool->UsedNo--;
+#endif
+  return OS_MEMPOOL_OK;
+}
+
+/* Pick the head of the highest non-empty priority list and pend PendSV when the decision changes.
+   NextTask always holds the latest decision; PendSV may be preempted between reading it and
+   publishing CurrentTask, so a changed decision is always re-pended rather than compared with
+   CurrentTask. The idle task is never removed, so the bitmap is never empty. */
+static void OS_Schedule(void){
+  
+  Task_ref* pNext = OS_ReadyFirst();
+  
+  if(pNext != OS_Control.NextTask){
+    if(OS_Control.NextTask->TaskState == Running){
+      OS_Control.NextTask->TaskState = Ready;
+    }
+    pNext->TaskState = Running;
+    OS_Control.NextTask = pNext;
+    //Trigger OS_PendSV
+    OS_PORT_PEND_SWITCH();
+  }
+}
+
+/* Publish NextTask as CurrentTask, for ports that switch in C; returns the task switched out */
+Task_ref* OS_Switch_Commit(void){
+  
+  Task_ref* pPrevious = OS_Control.CurrentTask;
+  
+  OS_Control.CurrentTask = OS_Control.NextTask;
+  return pPrevious;
+}
+
+#if OS_SWITCH_HOOK
+/* Called by the port on every switch, with the tick masked and Next already published as
+   CurrentTask: charges Previous with the cycles since the last switch (still Ready means it was
+   preempted) and traces the switch */
+void OS_Switch_Hook(Task_ref* Previous, Task_ref* Next){
+  
+#if OS_RUNTIME_STATS
+  uint32 now = OS_PORT_CYCLES();
+  
+  Previous->RunCycles += now - OS_Control.StatsStamp;
+  OS_Control.StatsStamp = now;
+  if(Previous->TaskState == Ready){
+    Previous->PreemptedNo++;
+  }
+  Next->SwitchInNo++;
+#endif
+  OS_TRACE_EVENT(OS_TRACE_SWITCH, Next, Previous->TraceId);
+}
+#endif
+
+#if OS_RUNTIME_STATS
+
+/* Close the load window every OS_RUNTIME_WINDOW ticks, the running task charged up to now. Only
+   the window is recorded here, the loads are divided out by the readers */
+static void OS_StatsWindow(uint32 Ticks){
+  
+  uint32 now;
+  Task_ref* pTask;
+  
+  OS_Control.WindowTicks += Ticks;
+  if(OS_Control.WindowTicks < OS_RUNTIME_WINDOW){
+    return;
+  }
+  OS_Control.WindowTicks = 0;
+  
+  now = OS_PORT_CYCLES();
+  OS_Control.CurrentTask->RunCycles += now - OS_Control.StatsStamp;
+  OS_Control.StatsStamp = now;
+  OS_Control.WindowLength = now - OS_Control.WindowStart;
+  OS_Control.WindowStart = now;
+  
+  for(uint32 i = 0; i < OS_Control.ActiveTasksNo; i++){
+    pTask = OS_Control.Tasks[i];
+    pTask->WindowCycles = (uint32)(pTask->RunCycles - pTask->WindowStartCycles);
+    pTask->WindowStartCycles = pTask->RunCycles;
+  }
+  OS_Control.WindowNo++;
+}
+#endif
+
+/* Microseconds since OS_Start: whole ticks plus the tick timer's progress into the next one.
+   Runs with the tick masked so g_tick and the timer are read as one */
+static void OS_TimeNow(uint64* pTime){
+  
+  uint64 ticks = ((uint64)g_tickWraps << 32) | g_tick;
+  
+  *pTime = (ticks * 1000U) + (((uint64)OS_Port_TickCounts() * 1000U) / OS_PORT_TICK_COUNTS);
+}
+
+/* Kernel side of SVC_Handler: Args points at the caller's r0-r3 */
+void OS_SVC_Service(uint32 SVC_Number, uintptr_t* Args){
+  
+  OS_TRACE_EVENT(OS_TRACE_SVC_ENTER, OS_Control.CurrentTask, SVC_Number);
+  switch(SVC_Number){
+  case 0:
+    //Activate the task passed in r0
+    OS_TaskRelease((Task_ref*)Args[0]);
+    break;
+  case 1:
+    //Suspend the task passed in r0
+    OS_TaskHold((Task_ref*)Args[0]);
+    break;
+  case 2:
+    OS_MutexLock((Mutex*)Args[0]);
+    break;
+  case 3:
+    OS_MutexUnlock((Mutex*)Args[0]);
+    break;
+  case 4:
+    OS_CountingSemaphoreTake((CountingSemaphore*)Args[0], (uint32)Args[1]);
+    break;
+  case 5:
+    OS_CountingSemaphoreGive((CountingSemaphore*)Args[0]);
+    break;
+  case 6:
+    OS_MessageQueueSend((MessageQueue*)Args[0], (uint32)Args[1]);
+    break;
+  case 7:
+    OS_MessageQueueReceive((MessageQueue*)Args[0], (uint32)Args[1]);
+    break;
+  case 8:
+    OS_Control.CurrentTask->WaitMessage = OS_MemPoolTake((MemPool*)Args[0]);
+    break;
+  case 9:
+    OS_Control.CurrentTask->WaitResult = OS_MemPoolPut((MemPool*)Args[0], (void*)Args[1]);
+    break;
+  case 10:
+    OS_EventSet((EventGroup*)Args[0], (uint32)Args[1]);
+    break;
+  case 11:
+    ((EventGroup*)Args[0])->Flags &= ~(uint32)Args[1];
+    break;
+  case 12:
+    OS_EventWait((EventGroup*)Args[0], (uint32)Args[1]);
+    break;
+#if OS_SOFTWARE_TIMERS
+  case 13:
+    //Start: arm unless already running
+    if((((SoftwareTimer*)Args[0])->State & OS_TIMER_ACTIVE) == 0U){
+      OS_TimerInsert((SoftwareTimer*)Args[0], ((SoftwareTimer*)Args[0])->Period);
+    }
+    break;
+  case 14:
+    OS_TimerRemove((SoftwareTimer*)Args[0]);
+    ((SoftwareTimer*)Args[0])->State &= ~OS_TIMER_DUE;
+    break;
+  case 15:
+    //Reset: restart the full period from now
+    OS_TimerInsert((SoftwareTimer*)Args[0], ((SoftwareTimer*)Args[0])->Period);
+    break;
+  case 16:
+    OS_TimerNextExpired();
+    break;
+#endif
+  case 17:
+  case 18:
+  case 19:
+    //Notify, the action is SVC_Number - 17: OS_NOTIFY_SET_BITS, _INCREMENT, _OVERWRITE
+    OS_Notify((Task_ref*)Args[0], (uint8)(SVC_Number - 17U), (uint32)Args[1]);
+    break;
+  case 20:
+    OS_NotifyWait((uint32)Args[0], (uint32)Args[1]);
+    break;
+  case 21:
+    OS_TimeNow((uint64*)Args[0]);
+    break;
+  case 22:
+    OS_BinarySemaphoreTake((BinarySemaphore*)Args[0], (Task_ref*)Args[1]);
+    break;
+  case 23:
+    OS_BinarySemaphoreGive((BinarySemaphore*)Args[0]);
+    break;
+  case 24:
+    //Tickless period already ended on entry, the reschedule below runs the tasks it woke
+    break;
+  default:
+    break;
+  }
+  
+  if(OS_Control.OS_STATE == OS_Running){
+    OS_Schedule();
+  }
+  OS_TRACE_EVENT(OS_TRACE_SVC_EXIT, OS_Control.CurrentTask, SVC_Number);
+}
+
+/* Let Ticks ticks pass without scheduling (used when a stretched tickless period is left early) */
+void OS_Tick_Advance(uint32 Ticks){
+  
+  if((g_tick + Ticks) < g_tick){
+    g_tickWraps++;
+  }
+  g_tick += Ticks;
+  OS_DelayAdvance(Ticks);
+#if OS_SOFTWARE_TIMERS
+  OS_TimerAdvance(Ticks);
+#endif
+}
+
+/* Kernel side of SysTick_Handler: Ticks is 1, or the length of the stretched period just ended */
+void OS_Tick_Service(uint32 Ticks){
+  
+  Task_ref* pCurrent = OS_Control.CurrentTask;
+  
+  OS_TRACE_EVENT(OS_TRACE_TICK, OS_Control.CurrentTask, Ticks);
+  OS_Tick_Advance(Ticks);
+#if OS_RUNTIME_STATS
+  OS_StatsWindow(Ticks);
+#endif
+  
+  //Round robin between tasks sharing the current priority, once the running one used its quantum
+  if((pCurrent->TaskState == Running) && (OS_Control.ReadyHead[pCurrent->Priority] == pCurrent)){
+    if(pCurrent->SliceTicks > Ticks){
+      pCurrent->SliceTicks -= Ticks;
+    }
+    else{
+      OS_SliceReload(pCurrent);
+      OS_ReadyRotate(pCurrent->Priority);
+    }
+  }
+  
+  OS_Schedule();
+  
+#if OS_TICKLESS_IDLE
+  //Only IDLETASK is ready: let the port skip the ticks until the next wakeup or timer expiry
+  if((OS_Control.ReadyBitmap == OS_PRIORITY_BIT(Idletask.Priority)) && (Idletask.p_NextReady == NULL) && (Idletask.p_PrevReady == NULL)){
+    uint32 idle = (OS_Control.DelayHead != NULL) ? OS_Control.DelayHead->DelayTicks : 0xFFFFFFFFU;
+    
+#if OS_SOFTWARE_TIMERS
+    if((OS_Control.TimerHead != NULL) && (OS_Control.TimerHead->DeltaTicks < idle)){
+      idle = OS_Control.TimerHead->DeltaTicks;
+    }
+#endif
+    if(idle >= OS_TICKLESS_MIN_IDLE){
+      OS_Port_SuppressTicks(idle);
+    }
+  }
+#endif
+}
+
+
+void IDLETASK(void){
+  
+#if OS_STACK_CHECK
+  uint32 task = 0;
+#endif
+  
+  while(1){
+#if OS_STACK_CHECK
+    //Refresh one task's high-water mark per idle pass
+    (void)OS_GetStackHighWater(OS_Control.Tasks[task]);
+    task++;
+    if(task >= OS_Control.ActiveTasksNo){
+      task = 0;
+    }
+#endif
+    OS_PORT_WAIT_FOR_EVENT();
+  }
+}
+
+
+
+#if OS_SOFTWARE_TIMERS
+/* Timer service task: runs the callbacks of expired timers in expiry order */
+void TIMERTASK(void){
+  
+  SoftwareTimer* pTimer;
+  
+  while(1){
+    OS_SVC(0x10, NULL);
+    pTimer = OS_Control.CurrentTask->WaitMessage;
+    if(pTimer != NULL){
+      pTimer->p_Callback(pTimer);
+    }
+  }
+}
+#endif
+
+
+/* Register a task with the kernel, its stack and initial frame already in place */
+static void OS_TaskInit(Task_ref* Task){
+  
+  OS_Control.Tasks[OS_Control.ActiveTasksNo] = Task;
+  OS_Control.ActiveTasksNo++;
+  
+  Task->TaskState = Suspended;
+  Task->p_NextReady = NULL;
+  Task->p_PrevReady = NULL;
+  Task->p_NextDelay = NULL;
+  Task->p_PrevDelay = NULL;
+  Task->DelayTicks = 0;
+  Task->BasePriority = Task->Priority;
+  Task->p_WaitingMutex = NULL;
+  Task->p_HeldMutexes = NULL;
+  Task->p_WaitList = NULL;
+  Task->WaitResult = OS_WAIT_OK;
+  Task->WaitMessage = NULL;
+  Task->WaitFlags = 0;
+  Task->WaitOptions = 0;
+  Task->StackHighWater = 0;
+  OS_SliceReload(Task);
+  Task->NotifyValue = 0;
+  Task->NotifyPending = FALSE;
+  Task->p_NotifyWaiter = NULL;
+  Task->AbsoluteDeadline = 0;
+  Task->HeapIndex = 0;
+#if OS_TRACE
+  OS_Trace_AddTask(Task, OS_Control.ActiveTasksNo - 1U);
+#endif
+#if OS_RUNTIME_STATS
+  Task->RunCycles = 0;
+  Task->WindowStartCycles = 0;
+  Task->SwitchInNo = 0;
+  Task->PreemptedNo = 0;
+  Task->WindowCycles = 0;
+#endif
+}
+
+#if OS_STATIC_TASKS
+/* Tasks laid out at compile time: the stacks are not loaded from the image, so only the initial
+   frame is written before linking them into the ready lists. No SVC, no stack allocation. */
+static void OS_StaticTaskInit(Task_ref* Task){
+  
+  OS_Port_InitStaticStack(Task);
+  OS_TaskInit(Task);
+  OS_TaskRelease(Task);
+}
+#endif
+
+
+void OS_Init(void){
+  
+  OS_Port_Init();
+  
+#if OS_STATIC_TASKS
+  OS_StaticTaskInit(&Idletask);
+  for(uint32 i = 0; i < TasksNo; i++){
+    if(Tasks_Configuration.Tasks[i].p_TaskEntry != NULL){
+      OS_StaticTaskInit(&Tasks_Configuration.Tasks[i]);
+    }
+  }
+#if OS_SOFTWARE_TIMERS
+  OS_StaticTaskInit(&TimerTask);
+#endif
+#else
+  Idletask.StackSize = 300;
+  Idletask.Priority = 20;
+  Idletask.p_TaskEntry = IDLETASK;
+  Idletask.TimingWaiting.Blocking = BlockingDisabled;
+  Idletask.TimingWaiting.Ticks_Count = 0;
+  strcpy(Idletask.TaskName, "IDLETASK");
+  OS_CreateTask(&Idletask);
+  
+#if OS_SOFTWARE_TIMERS
+  TimerTask.StackSize = OS_TIMER_TASK_STACK;
+  TimerTask.Priority = OS_TIMER_TASK_PRIORITY;
+  TimerTask.p_TaskEntry = TIMERTASK;
+  TimerTask.TimingWaiting.Blocking = BlockingDisabled;
+  TimerTask.TimingWaiting.Ticks_Count = 0;
+  strcpy((char*)TimerTask.TaskName, "TIMERTASK");
+  OS_CreateTask(&TimerTask);
+#endif
+#endif
+  
+}
+
+
+/* Kernel call made where SVC cannot be used (interrupt handlers, before OS_Start): the port
+   critical section stands in for the exception. A stretched tickless period is ended first, as
+   on SVC entry. The switch OS_SVC_Service pends is taken when the outermost handler returns:
+   PendSV has the lowest priority on the CM4, the host switches on the outermost critical exit. */
+static void OS_HandlerCall(uint32 SVC_Number, uintptr_t Arg0, uintptr_t Arg1){
+  
+  OS_Port_CriticalState state;
+  uintptr_t args[4] = {Arg0, Arg1, 0, 0};
+  
+  OS_PORT_ENTER_CRITICAL(state);
+  OS_Port_ResumeTicks();
+  OS_SVC_Service(SVC_Number, args);
+  OS_PORT_EXIT_CRITICAL(state);
+}
+
+
+void OS_CreateTask(Task_ref* Task){
+  
+  /**Create Task Stack**/
+  OS_Port_InitTaskStack(Task);
+  
+  OS_TaskInit(Task);
+  OS_ActivateTask(Task);
+  
+}
+
+/* Safe from interrupt handlers: an ISR wakes its task directly instead of setting a flag it polls */
+void OS_ActivateTask(Task_ref* Task){
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_HandlerCall(0x00, (uintptr_t)Task, 0);
+    return;
+  }
+  /**Trigger SVC**/
+  OS_SVC(0x00, Task);
+  
+}
+
+
+void OS_TerminateTask(Task_ref* Task){
+  
+  /**Trigger SVC**/
+  OS_SVC(0x01, Task);
+}
+
+
+void OS_HoldTask(Task_ref* Task){
+  
+  /**Trigger SVC**/
+  OS_SVC(0x01, Task);
+  
+}
+uint32 OS_GetTime(void){
+  
+  return g_tick;
+  
+}
+
+/* Monotonic 64-bit time in microseconds, from tasks and interrupt handlers. Tasks go through
+   SVC since the tick timer is privileged; handlers read it directly, without OS_HandlerCall,
+   so a time stamp does not end a tickless period */
+uint64 OS_GetTimeUs(void){
+  
+  uint64 time;
+  OS_Port_CriticalState state;
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_PORT_ENTER_CRITICAL(state);
+    OS_TimeNow(&time);
+    OS_PORT_EXIT_CRITICAL(state);
+  }
+  else{
+    OS_SVC(0x15, &time);
+  }
+  return time;
+  
+}
+
+/* End a stretched tickless period before privileged code reprograms the tick timer (Clock_Set):
+   the ticks slept so far are credited and the tasks they wake are scheduled */
+void OS_TickSync(void){
+  
+  OS_HandlerCall(0x18, 0, 0);
+  
+}
+
+Task_ref* OS_GetCurrentTask(void){
+  
+  return OS_Control.CurrentTask;
+  
+}
+
+/* Tasks in creation order, NULL past the last one */
+Task_ref* OS_GetTask(uint32 Index){
+  
+  return (Index < OS_Control.ActiveTasksNo) ? OS_Control.Tasks[Index] : NULL;
+  
+}
+
+void OS_Start(void){
+  
+  OS_Control.OS_STATE = OS_Running;
+  
+  OS_Control.CurrentTask = OS_ReadyFirst();
+  OS_Control.CurrentTask->TaskState = Running;
+  OS_Control.NextTask = OS_Control.CurrentTask;
+#if OS_RUNTIME_STATS
+  OS_Control.CurrentTask->SwitchInNo++;
+  OS_Control.StatsStamp = OS_PORT_CYCLES();
+  OS_Control.WindowStart = OS_Control.StatsStamp;
+#endif
+  
+  OS_Port_StartFirstTask(OS_Control.CurrentTask);
+  
+}
+
+/* Signal Task directly (OS_NOTIFY_SET_BITS/INCREMENT/OVERWRITE with Value), from tasks or
+   interrupt handlers. The cheapest wake in the kernel: no object, no wait-list walk. */
+void OS_TaskNotify(Task_ref* Task, uint32 Value, uint8 Action){
+  
+  //One SVC number per action: svc takes its number as an immediate
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_HandlerCall((Action <= OS_NOTIFY_OVERWRITE) ? (0x11U + Action) : 0x13U, (uintptr_t)Task, Value);
+  }
+  else if(Action == OS_NOTIFY_SET_BITS){
+    OS_SVC2(0x11, Task, Value);
+  }
+  else if(Action == OS_NOTIFY_INCREMENT){
+    OS_SVC2(0x12, Task, Value);
+  }
+  else{
+    OS_SVC2(0x13, Task, Value);
+  }
+  
+}
+
+
+/* Wait up to Timeout ticks for a notification of the calling task. On OS_WAIT_OK *pValue (if not
+   NULL) gets the value, then the ClearOnExit bits of it are cleared (0xFFFFFFFF: reset to 0). */
+uint8 OS_TaskNotifyWait(uint32 ClearOnExit, uint32 Timeout, uint32* pValue){
+  
+  OS_SVC2(0x14, ClearOnExit, Timeout);
+  if((OS_Control.CurrentTask->WaitResult == OS_WAIT_OK) && (pValue != NULL)){
+    *pValue = OS_Control.CurrentTask->WaitFlags;
+  }
+  return OS_Control.CurrentTask->WaitResult;
+  
+}
+
+
+/* A second taker while one is parked is ignored: one task per binary semaphore */
+void SemaphoreTake(BinarySemaphore* Semaphore, Task_ref* task){
+  
+  OS_SVC2(0x16, Semaphore, task);
+  
+}
+
+
+void SemaphoreGive(BinarySemaphore* Semaphore){
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_HandlerCall(0x17, (uintptr_t)Semaphore, 0);
+    return;
+  }
+  OS_SVC(0x17, Semaphore);
+  
+}
+
+
+void MutexLock(Mutex* pMutex){
+  
+  OS_SVC(0x02, pMutex);
+  
+}
+
+
+void MutexUnlock(Mutex* pMutex){
+  
+  OS_SVC(0x03, pMutex);
+  
+}
+
+
+/* Take one unit, waiting up to Timeout ticks (OS_NO_WAIT / OS_WAIT_FOREVER).
+   Returns OS_WAIT_OK or OS_WAIT_TIMEOUT. */
+uint8 CountingSemaphoreTake(CountingSemaphore* pSemaphore, uint32 Timeout){
+  
+  OS_SVC2(0x04, pSemaphore, Timeout);
+  return OS_Control.CurrentTask->WaitResult;
+  
+}
+
+
+/* Safe from interrupt handlers */
+void CountingSemaphoreGive(CountingSemaphore* pSemaphore){
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_HandlerCall(0x05, (uintptr_t)pSemaphore, 0);
+    return;
+  }
+  OS_SVC(0x05, pSemaphore);
+  
+}
+
+
+void MessageQueueInit(MessageQueue* pQueue, void** Buffer, uint32 Length){
+  
+  pQueue->Buffer = Buffer;
+  pQueue->Length = Length;
+  pQueue->Head = 0;
+  pQueue->Count = 0;
+  pQueue->p_SendWaitHead = NULL;
+  pQueue->p_ReceiveWaitHead = NULL;
+  
+}
+
+
+/* Pass Message (normally a pool block, ownership moves with it), waiting up to Timeout ticks
+   for a free slot. Returns OS_WAIT_OK or OS_WAIT_TIMEOUT. */
+uint8 MessageQueueSend(MessageQueue* pQueue, void* Message, uint32 Timeout){
+  
+  OS_Control.CurrentTask->WaitMessage = Message;
+  OS_SVC2(0x06, pQueue, Timeout);
+  return OS_Control.CurrentTask->WaitResult;
+  
+}
+
+
+uint8 MessageQueueReceive(MessageQueue* pQueue, void** pMessage, uint32 Timeout){
+  
+  OS_SVC2(0x07, pQueue, Timeout);
+  if(OS_Control.CurrentTask->WaitResult == OS_WAIT_OK){
+    *pMessage = OS_Control.CurrentTask->WaitMessage;
+  }
+  return OS_Control.CurrentTask->WaitResult;
+  
+}
+
+
+/* Interrupt handler variants: never block, return OS_WAIT_TIMEOUT when full/empty.
+   A task they release is switched in by PendSV once the last nested handler returns. */
+uint8 MessageQueueSendFromISR(MessageQueue* pQueue, void* Message){
+  
+  OS_Port_CriticalState state;
+  uint8 result;
+  
+  OS_PORT_ENTER_CRITICAL(state);
+  OS_Port_ResumeTicks();
+  result = OS_QueuePut(pQueue, Message);
+  if(OS_Control.OS_STATE == OS_Running){
+    OS_Schedule();
+  }
+  OS_PORT_EXIT_CRITICAL(state);
+  return result;
+  
+}
+
+
+uint8 MessageQueueReceiveFromISR(MessageQueue* pQueue, void** pMessage){
+  
+  OS_Port_CriticalState state;
+  uint8 result;
+  
+  OS_PORT_ENTER_CRITICAL(state);
+  OS_Port_ResumeTicks();
+  result = OS_QueueGet(pQueue, pMessage);
+  if(OS_Control.OS_STATE == OS_Running){
+    OS_Schedule();
+  }
+  OS_PORT_EXIT_CRITICAL(state);
+  return result;
+  
+}
+
+
+/* Thread the free list through Buffer (see OS_MEMPOOL_BUFFER), before the pool is shared */
+void MemPoolInit(MemPool* pPool, void* Buffer, uint32 BlockSize, uint32 BlocksNo){
+  
+  uint8* pBlock;
+  
+  pPool->BlockSize = OS_MEMPOOL_BLOCK_WORDS(BlockSize) * sizeof(uintptr_t);
+  pPool->BlocksNo = BlocksNo;
+  pPool->p_Start = Buffer;
+  pPool->p_End = pPool->p_Start + pPool->BlockSize * BlocksNo;
+  pPool->p_FreeHead = NULL;
+#if OS_MEMPOOL_STATS
+  pPool->UsedNo = BlocksNo;
+  pPool->PeakUsedNo = 0;
+  pPool->FailedNo = 0;
+  pPool->InvalidFreeNo = 0;
+#endif
+  
+  //Push from the end so blocks are handed out in address order
+  for(pBlock = pPool->p_End; pBlock != pPool->p_Start; ){
+    pBlock -= pPool->BlockSize;
+    ((uintptr_t*)pBlock)[1] = 0;
+    (void)OS_MemPoolPut(pPool, pBlock);
+  }
+  
+}
+
+
+/* O(1) from tasks (through SVC) and interrupt handlers (port critical section); NULL when empty */
+void* MemPoolAlloc(MemPool* pPool){
+  
+  OS_Port_CriticalState state;
+  void* pBlock;
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_PORT_ENTER_CRITICAL(state);
+    pBlock = OS_MemPoolTake(pPool);
+    OS_PORT_EXIT_CRITICAL(state);
+    return pBlock;
+  }
+  OS_SVC(0x08, pPool);
+  return OS_Control.CurrentTask->WaitMessage;
+  
+}
+
+
+/* Returns OS_MEMPOOL_OK, or OS_MEMPOOL_INVALID for a foreign block or a double free */
+uint8 MemPoolFree(MemPool* pPool, void* Block){
+  
+  OS_Port_CriticalState state;
+  uint8 result;
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_PORT_ENTER_CRITICAL(state);
+    result = OS_MemPoolPut(pPool, Block);
+    OS_PORT_EXIT_CRITICAL(state);
+    return result;
+  }
+  OS_SVC2(0x09, pPool, Block);
+  return OS_Control.CurrentTask->WaitResult;
+  
+}
+
+
+#if OS_STACK_CHECK
+/* Stack bytes a task has ever used: the port paints [_E_PSP_Task, _S_PSP_Task) with
+   OS_STACK_PAINT, the words still painted are counted up from the stack end */
+uint32 OS_GetStackHighWater(Task_ref* Task){
+  
+  uint32* pWord = Task->_E_PSP_Task;
+  
+  while((pWord < Task->_S_PSP_Task) && (*pWord == OS_STACK_PAINT)){
+    pWord++;
+  }
+  Task->StackHighWater = (uint32)((uint8*)Task->_S_PSP_Task - (uint8*)pWord);
+  return Task->StackHighWater;
+  
+}
+
+
+/* StackSize to put in OS_Cfg.c: high-water mark plus OS_STACK_MARGIN, 8-byte aligned */
+uint32 OS_GetStackSuggestedSize(Task_ref* Task){
+  
+  return ((OS_GetStackHighWater(Task) + OS_STACK_MARGIN + 7U) / 8U) * 8U;
+  
+}
+
+
+/* The last word of the stack was written: the task reached (or ran past) its end */
+boolean OS_StackOverflowed(const Task_ref* Task){
+  
+  return (*Task->_E_PSP_Task != OS_STACK_PAINT) ? TRUE : FALSE;
+  
+}
+#endif
+
+
+#if OS_RUNTIME_STATS
+/* Share of the last complete window in 1/1000, read again if SysTick closes a window meanwhile */
+static uint32 OS_WindowLoad(const Task_ref* Task){
+  
+  const volatile Task_ref* pTask = Task;
+  uint32 window;
+  uint32 cycles;
+  uint32 length;
+  
+  do{
+    window = *(volatile uint32*)&OS_Control.WindowNo;
+    cycles = pTask->WindowCycles;
+    length = *(volatile uint32*)&OS_Control.WindowLength;
+  }while(window != *(volatile uint32*)&OS_Control.WindowNo);
+  
+  return (length != 0U) ? (uint32)(((uint64)cycles * 1000U) / length) : 0U;
+}
+
+/* RunCycles is 64-bit and charged from PendSV: read until two passes agree */
+void OS_GetRunTimeStats(const Task_ref* Task, OS_RunTimeStats* pStats){
+  
+  const volatile Task_ref* pTask = Task;
+  
+  do{
+    pStats->RunCycles = pTask->RunCycles;
+    pStats->SwitchInNo = pTask->SwitchInNo;
+    pStats->PreemptedNo = pTask->PreemptedNo;
+  }while((pStats->RunCycles != pTask->RunCycles) || (pStats->SwitchInNo != pTask->SwitchInNo));
+  pStats->LoadPermille = OS_WindowLoad(Task);
+}
+
+/* CPU share of Task over the last complete OS_RUNTIME_WINDOW, in 1/1000. The windows tumble: the
+   value is replaced once per window rather than sliding with every tick */
+uint32 OS_GetCpuLoad(const Task_ref* Task){
+  
+  return OS_WindowLoad(Task);
+}
+
+uint32 OS_GetIdleLoad(void){
+  
+  return OS_WindowLoad(&Idletask);
+}
+#endif
+
+
+/* Set/clear from tasks (through SVC) or interrupt handlers (port critical section) */
+void EventGroupSet(EventGroup* pGroup, uint32 Flags){
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_HandlerCall(0x0A, (uintptr_t)pGroup, Flags);
+    return;
+  }
+  OS_SVC2(0x0A, pGroup, Flags);
+  
+}
+
+
+void EventGroupClear(EventGroup* pGroup, uint32 Flags){
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_HandlerCall(0x0B, (uintptr_t)pGroup, Flags);
+    return;
+  }
+  OS_SVC2(0x0B, pGroup, Flags);
+  
+}
+
+
+/* Wait up to Timeout ticks for any/all of Flags (OS_EVENT_WAIT_ANY/ALL, | OS_EVENT_CLEAR to
+   consume them). On OS_WAIT_OK *pFlags (if not NULL) gets the group's flags that ended the wait. */
+uint8 EventGroupWait(EventGroup* pGroup, uint32 Flags, uint8 Options, uint32 Timeout, uint32* pFlags){
+  
+  OS_Control.CurrentTask->WaitFlags = Flags;
+  OS_Control.CurrentTask->WaitOptions = Options;
+  OS_SVC2(0x0C, pGroup, Timeout);
+  if((OS_Control.CurrentTask->WaitResult == OS_WAIT_OK) && (pFlags != NULL)){
+    *pFlags = OS_Control.CurrentTask->WaitFlags;
+  }
+  return OS_Control.CurrentTask->WaitResult;
+  
+}
+
+
+#if OS_SOFTWARE_TIMERS
+/* Set up a stopped timer; a Period of 0 is taken as 1 tick */
+void SoftwareTimerCreate(SoftwareTimer* pTimer, void(*Callback)(SoftwareTimer* Timer), uint32 Period, uint8 Mode){
+  
+  pTimer->p_Callback = Callback;
+  pTimer->Period = (Period != 0U) ? Period : 1U;
+  pTimer->Mode = Mode;
+  pTimer->State = 0;
+  pTimer->p_Next = NULL;
+  pTimer->p_Prev = NULL;
+  pTimer->DeltaTicks = 0;
+  pTimer->p_NextExpired = NULL;
+  
+}
+
+
+/* Arm the timer for Period ticks, no effect while it is already running */
+void SoftwareTimerStart(SoftwareTimer* pTimer){
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_HandlerCall(0x0D, (uintptr_t)pTimer, 0);
+    return;
+  }
+  OS_SVC(0x0D, pTimer);
+  
+}
+
+
+/* Disarm the timer and drop a callback that has not run yet */
+void SoftwareTimerStop(SoftwareTimer* pTimer){
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_HandlerCall(0x0E, (uintptr_t)pTimer, 0);
+    return;
+  }
+  OS_SVC(0x0E, pTimer);
+  
+}
+
+
+/* Restart the full Period from now, starting the timer if it was stopped */
+void SoftwareTimerReset(SoftwareTimer* pTimer){
+  
+  if(OS_PORT_IN_HANDLER() || (OS_Control.OS_STATE != OS_Running)){
+    OS_HandlerCall(0x0F, (uintptr_t)pTimer, 0);
+    return;
+  }
+  OS_SVC(0x0F, pTimer);
   
 }
+#endif
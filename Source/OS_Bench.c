@@ -0,0 +1,244 @@
+#include "OS_Bench.h"
+
+#if defined(OS_PORT_POSIX)
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#endif
+
+OS_BenchStat OS_Bench_TickStat       = {.Name = "SysTick_Handler"};
+OS_BenchStat OS_Bench_SVCStat        = {.Name = "SVC_Handler"};
+OS_BenchStat OS_Bench_IRQLatencyStat = {.Name = "IRQ latency"};
+
+/* Period of the latency probe interrupt, deliberately not a multiple of the 1 ms tick so it
+   sweeps every phase of SysTick/SVC activity */
+#define OS_BENCH_IRQ_PERIOD_CYCLES   ((SystemCoreClock / 1000U) + 7U)
+#define OS_BENCH_IRQ_PERIOD_NS       1000700U
+
+
+#if defined(OS_PORT_POSIX)
+
+static struct timespec OS_Bench_IRQStart;
+
+static uint64 OS_Bench_Nanoseconds(const struct timespec* Time){
+  
+  return (uint64)Time->tv_sec * 1000000000ULL + (uint64)Time->tv_nsec;
+}
+
+/* Host stand-in for Timer 0A: delay between the timer expiry and the handler */
+static void OS_Bench_IRQHandler(int Signal){
+  
+  struct timespec now;
+  
+  (void)Signal;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  OS_Bench_Record(&OS_Bench_IRQLatencyStat,
+                  (uint32)((OS_Bench_Nanoseconds(&now) - OS_Bench_Nanoseconds(&OS_Bench_IRQStart)) % OS_BENCH_IRQ_PERIOD_NS));
+}
+
+void OS_Bench_Init(void){
+  
+  struct sigaction action;
+  struct sigevent event;
+  struct itimerspec period;
+  timer_t timer;
+  
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = OS_Bench_IRQHandler;
+  sigemptyset(&action.sa_mask);
+  sigaddset(&action.sa_mask, SIGALRM);
+  action.sa_flags = SA_RESTART;
+  sigaction(OS_PORT_POSIX_IRQ_SIGNAL, &action, NULL);
+  
+  memset(&event, 0, sizeof(event));
+  event.sigev_notify = SIGEV_SIGNAL;
+  event.sigev_signo = OS_PORT_POSIX_IRQ_SIGNAL;
+  timer_create(CLOCK_MONOTONIC, &event, &timer);
+  
+  period.it_interval.tv_sec = 0;
+  period.it_interval.tv_nsec = OS_BENCH_IRQ_PERIOD_NS;
+  period.it_value = period.it_interval;
+  clock_gettime(CLOCK_MONOTONIC, &OS_Bench_IRQStart);
+  OS_Bench_IRQStart.tv_nsec += OS_BENCH_IRQ_PERIOD_NS;
+  if(OS_Bench_IRQStart.tv_nsec >= 1000000000L){
+    OS_Bench_IRQStart.tv_nsec -= 1000000000L;
+    OS_Bench_IRQStart.tv_sec++;
+  }
+  period.it_value = OS_Bench_IRQStart;
+  timer_settime(timer, TIMER_ABSTIME, &period, NULL);
+}
+
+void OS_Bench_Print(const char* Text){
+  
+  fputs(Text, stdout);
+  fflush(stdout);
+}
+
+#else
+
+/* Timer 0A (IRQ 19) at priority 2: below SVC/SysTick, above PendSV. The counts the timer has
+   run since its timeout are the cycles the interrupt waited for the kernel. */
+void Interrupt19_Handler(void){
+  
+  OS_Bench_Record(&OS_Bench_IRQLatencyStat, TIMER0_TAILR_R - TIMER0_TAV_R);
+  TIMER0_ICR_R = 0x1;
+}
+
+void OS_Bench_Init(void){
+  
+  //Baud divisor in 1/64ths: SystemCoreClock / (16 * 115200), rounded
+  uint32 divisor = ((SystemCoreClock * 4U) + (115200U / 2U)) / 115200U;
+  
+  //UART0 on PA0/PA1, 115200 8N1 from the system clock
+  SYSCTL_RCGCUART_R |= SYSCTL_RCGCUART_R0;
+  SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R0;
+  while((SYSCTL_RCGCGPIO_R & SYSCTL_RCGCGPIO_R0) == 0){}
+  UART0_CTL_R = 0;
+  UART0_IBRD_R = divisor >> 6;
+  UART0_FBRD_R = divisor & 0x3FU;
+  UART0_LCRH_R = 0x70;                       //8 bit, FIFO enabled
+  UART0_CC_R = 0;
+  UART0_CTL_R = 0x301;                       //UARTEN, TXE, RXE
+  GPIO_PORTA_AFSEL_R |= 0x03;
+  GPIO_PORTA_PCTL_R = (GPIO_PORTA_PCTL_R & ~0xFFU) | 0x11;
+  GPIO_PORTA_DEN_R |= 0x03;
+  
+  //Timer 0A periodic latency probe
+  SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R0;
+  while((SYSCTL_RCGCTIMER_R & SYSCTL_RCGCTIMER_R0) == 0){}
+  TIMER0_CTL_R = 0;
+  TIMER0_CFG_R = 0;                          //32-bit
+  TIMER0_TAMR_R = 0x2;                       //Periodic, count down
+  TIMER0_TAILR_R = OS_BENCH_IRQ_PERIOD_CYCLES - 1;
+  TIMER0_ICR_R = 0x1;
+  TIMER0_IMR_R = 0x1;
+  NVIC_SetPriority((IRQn_Type)19, 2U);
+  NVIC_EnableIRQ((IRQn_Type)19);
+  TIMER0_CTL_R = 0x1;
+}
+
+void OS_Bench_Print(const char* Text){
+  
+  while(*Text != '\0'){
+    while((UART0_FR_R & 0x20) != 0){}        //TX FIFO full
+    UART0_DR_R = *Text;
+    Text++;
+  }
+}
+
+#endif
+
+
+void OS_Bench_Reset(OS_BenchStat* Stat){
+  
+  Stat->Count = 0;
+  Stat->Min = 0xFFFFFFFFU;
+  Stat->Max = 0;
+  Stat->Sum = 0;
+  for(uint8 i = 0; i < OS_BENCH_BUCKETS; i++){
+    Stat->Histogram[i] = 0;
+  }
+}
+
+void OS_Bench_Record(OS_BenchStat* Stat, uint32 Value){
+  
+  uint32 bucket = Value / OS_BENCH_BUCKET_WIDTH;
+  
+  if(Stat->Count == 0){
+    Stat->Min = 0xFFFFFFFFU;
+  }
+  if(Value < Stat->Min){
+    Stat->Min = Value;
+  }
+  if(Value > Stat->Max){
+    Stat->Max = Value;
+  }
+  Stat->Sum += Value;
+  Stat->Count++;
+  
+  if(bucket >= OS_BENCH_BUCKETS){
+    bucket = OS_BENCH_BUCKETS - 1;
+  }
+  Stat->Histogram[bucket]++;
+}
+
+void OS_Bench_PrintNumber(uint32 Value){
+  
+  char text[11];
+  uint8 i = sizeof(text) - 1;
+  
+  text[i] = '\0';
+  do{
+    text[--i] = (char)('0' + (Value % 10));
+    Value /= 10;
+  }while(Value != 0);
+  OS_Bench_Print(&text[i]);
+}
+
+void OS_Bench_Report(const OS_BenchStat* Stat){
+  
+  OS_Bench_Print(Stat->Name);
+  if(Stat->Count == 0){
+    OS_Bench_Print(": no samples\r\n");
+    return;
+  }
+  OS_Bench_Print(": n=");
+  OS_Bench_PrintNumber(Stat->Count);
+  OS_Bench_Print(" min=");
+  OS_Bench_PrintNumber(Stat->Min);
+  OS_Bench_Print(" avg=");
+  OS_Bench_PrintNumber((uint32)(Stat->Sum / Stat->Count));
+  OS_Bench_Print(" max=");
+  OS_Bench_PrintNumber(Stat->Max);
+  OS_Bench_Print(" " OS_PORT_CYCLES_UNIT "\r\n");
+  
+  for(uint8 i = 0; i < OS_BENCH_BUCKETS; i++){
+    if(Stat->Histogram[i] != 0){
+      OS_Bench_Print("  ");
+      OS_Bench_PrintNumber(i * OS_BENCH_BUCKET_WIDTH);
+      OS_Bench_Print((i == OS_BENCH_BUCKETS - 1) ? "+ : " : " : ");
+      OS_Bench_PrintNumber(Stat->Histogram[i]);
+      OS_Bench_Print("\r\n");
+    }
+  }
+}
+
+/* One line per task: configured StackSize, high-water mark and the StackSize to configure */
+void OS_Bench_StackReport(void){
+  
+#if OS_STACK_CHECK
+  Task_ref* pTask;
+  
+  for(uint32 i = 0; (pTask = OS_GetTask(i)) != NULL_PTR; i++){
+    OS_Bench_Print((const char*)pTask->TaskName);
+    OS_Bench_Print(": size=");
+    OS_Bench_PrintNumber(pTask->StackSize);
+    OS_Bench_Print(" used=");
+    OS_Bench_PrintNumber(OS_GetStackHighWater(pTask));
+    OS_Bench_Print(" suggest=");
+    OS_Bench_PrintNumber(OS_GetStackSuggestedSize(pTask));
+    OS_Bench_Print(OS_StackOverflowed(pTask) ? " OVERFLOW\r\n" : "\r\n");
+  }
+#endif
+}
+
+/* One line per task: CPU share of the last OS_RUNTIME_WINDOW, switches in and preemptions */
+void OS_Bench_LoadReport(void){
+  
+#if OS_RUNTIME_STATS
+  Task_ref* pTask;
+  OS_RunTimeStats stats;
+  
+  for(uint32 i = 0; (pTask = OS_GetTask(i)) != NULL_PTR; i++){
+    OS_GetRunTimeStats(pTask, &stats);
+    OS_Bench_Print((const char*)pTask->TaskName);
+    OS_Bench_Print(": load=");
+    OS_Bench_PrintNumber(stats.LoadPermille);
+    OS_Bench_Print("/1000 switches=");
+    OS_Bench_PrintNumber(stats.SwitchInNo);
+    OS_Bench_Print(" preempted=");
+    OS_Bench_PrintNumber(stats.PreemptedNo);
+    OS_Bench_Print("\r\n");
+  }
+#endif
+}
@@ -1,26 +1,48 @@
 #include "Schedular.h"
 #include "ECU1.h"
 
-Task_Config Tasks_Configuration = {
+#if OS_STATIC_TASKS
+OS_STATIC_STACK(Send_KeepAlive_TaskStack, 300);
+OS_STATIC_STACK(Receive_KeepAlive_TaskStack, 300);
+OS_STATIC_STACK(switchStatesStack, 300);
+OS_STATIC_STACK(Process_ADC_ReadingStack, 300);
+OS_STATIC_STACK(DTC_TaskStack, 300);
+OS_STATIC_STACK(No_Communication_TaskStack, 100);
+OS_STATIC_STACK(Overheat_TaskStack, 100);
+OS_STATIC_STACK(Send_message_to_PCStack, 100);
+#endif
+
+Task_Config Tasks_Configuration OS_STATIC_TASK_ATTRIBUTE = {
  .Tasks=  
   {
     {
+#if OS_STATIC_TASKS
+      OS_STATIC_TASK_STACK(Send_KeepAlive_TaskStack),
+#endif
       .StackSize = 300,
       .Priority = 5,
       .p_TaskEntry = Send_KeepAlive_Task,
       .TimingWaiting.Blocking = BlockingEnabled,
       .TimingWaiting.Ticks_Count = 100,
+      .TimeSlice = 10,
       .TaskName = "task1"
     },
     {
+#if OS_STATIC_TASKS
+      OS_STATIC_TASK_STACK(Receive_KeepAlive_TaskStack),
+#endif
       .StackSize = 300,
       .Priority = 5,
       .p_TaskEntry = Receive_KeepAlive_Task,
       .TimingWaiting.Blocking = BlockingEnabled,
       .TimingWaiting.Ticks_Count = 100,
+      .TimeSlice = 10,
       .TaskName = "task2"
     },
     {
+#if OS_STATIC_TASKS
+      OS_STATIC_TASK_STACK(switchStatesStack),
+#endif
       .StackSize = 300,
       .Priority = 3,
       .p_TaskEntry = switchStates,
@@ -29,6 +51,9 @@ Task_Config Tasks_Configuration = {
       .TaskName = "task3"
     },
     {
+#if OS_STATIC_TASKS
+      OS_STATIC_TASK_STACK(Process_ADC_ReadingStack),
+#endif
       .StackSize = 300,
       .Priority = 5,
       .p_TaskEntry = Process_ADC_Reading,
@@ -37,6 +62,9 @@ Task_Config Tasks_Configuration = {
       .TaskName = "task4"
     },
     {
+#if OS_STATIC_TASKS
+      OS_STATIC_TASK_STACK(DTC_TaskStack),
+#endif
       .StackSize = 300,
       .Priority = 4,
       .p_TaskEntry = DTC_Task,
@@ -45,6 +73,9 @@ Task_Config Tasks_Configuration = {
       .TaskName = "task5"
     },
     {
+#if OS_STATIC_TASKS
+      OS_STATIC_TASK_STACK(No_Communication_TaskStack),
+#endif
       .StackSize = 100,
       .Priority = 2,
       .p_TaskEntry = No_Communication_Task,
@@ -53,6 +84,9 @@ Task_Config Tasks_Configuration = {
       .TaskName = "task6"
     },
     {
+#if OS_STATIC_TASKS
+      OS_STATIC_TASK_STACK(Overheat_TaskStack),
+#endif
       .StackSize = 100,
       .Priority = 2,
       .p_TaskEntry = Overheat_Task,
@@ -61,6 +95,9 @@ Task_Config Tasks_Configuration = {
       .TaskName = "task7"
     },
     {
+#if OS_STATIC_TASKS
+      OS_STATIC_TASK_STACK(Send_message_to_PCStack),
+#endif
       .StackSize = 100,
       .Priority = 1,
       .p_TaskEntry = Send_message_to_PC,
@@ -78,4 +115,12 @@ Semaphore_Config BinarySem = {
     [1] = &(BinarySemaphore){NULL_PTR, NULL_PTR, "Task2Semaphore"}
   }
   
+};
+
+Mutex_Config Mutexes_Configuration = {
+  .Mutexes = {
+    [0] = &(Mutex){.MutexName = "SwitchStatesMutex"},
+    [1] = &(Mutex){.MutexName = "SendStatesMutex"}
+  }
+  
 };
\ No newline at end of file
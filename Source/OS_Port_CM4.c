@@ -0,0 +1,258 @@
+#include "Schedular.h"
+#include "OS_Bench.h"
+
+#if !defined(OS_PORT_POSIX)
+
+extern uint32_t __INITIAL_SP;
+uint32* StackFrame;
+uint32 SVC_Number;
+
+static struct{
+  
+  uint32*        _S_MSP_Task;
+  uint32*        _E_MSP_Task;
+  uint32*        _PSP_TaskLocator;
+  
+  /* Ticks covered by the stretched SysTick period, 0 while ticking every 1 ms */
+  uint32        TicklessTicks;
+  
+}OS_PortControl;
+
+
+void OS_Port_Init(void){
+  
+  //Core clock first: SysTick, the cycle counter rate and the bench UART follow SystemCoreClock
+  Clock_Init();
+  
+  OS_PortControl._S_MSP_Task = &__INITIAL_SP;
+  OS_PortControl._E_MSP_Task = (uint32*)((((uint32)OS_PortControl._S_MSP_Task - 1000)/8)*8);
+  OS_PortControl._PSP_TaskLocator = (uint32*)((((uint32)OS_PortControl._E_MSP_Task - 8)/8)*8);
+  
+  //Cycle counter used by the benchmark and run-time statistics
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  
+#if (__FPU_USED == 1U)
+  //Automatic state preservation with lazy stacking: the FP frame is only reserved on exception
+  //entry and written when the handler itself uses the FPU
+  FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+#endif
+  
+  //NVIC_SetPriority(SysTick_IRQn, 0U);
+  *(uint32_t volatile *)0xE000ED20 |= (0xFFU << 16);
+}
+
+
+void OS_Port_InitTaskStack(Task_ref* Task){
+  
+  Task->_S_PSP_Task = OS_PortControl._PSP_TaskLocator;
+  Task->_E_PSP_Task = (uint32*)((((uint32)(Task->_S_PSP_Task) - Task->StackSize)/8)*8);
+  OS_PortControl._PSP_TaskLocator = Task->_E_PSP_Task - 30;
+  OS_Port_InitStaticStack(Task);
+}
+
+
+void OS_Port_InitStaticStack(Task_ref* Task){
+  
+#if OS_STACK_CHECK
+  for(uint32* pWord = Task->_E_PSP_Task; pWord < Task->_S_PSP_Task; pWord++){
+    *pWord = OS_STACK_PAINT;
+  }
+#endif
+  
+  Task->Current_PSP = Task->_S_PSP_Task;
+  
+  Task->Current_PSP--;                       //XPSR
+  *(Task->Current_PSP) &= 0x0;
+  *(Task->Current_PSP) = 0x01000000;
+  
+  Task->Current_PSP--;                       //PC
+  *(Task->Current_PSP) &= 0x0;
+  *(Task->Current_PSP) = (uint32)(Task->p_TaskEntry);
+  
+  Task->Current_PSP--;                       //LR
+  *(Task->Current_PSP) = 0x0;
+  *(Task->Current_PSP) = 0xFFFFFFFD;         //Return to Thread with PSP
+  
+  for(uint8 i = 0; i < 5; i++){               //R12, R3 - R0
+    Task->Current_PSP--;
+    *(Task->Current_PSP) = 0x0;
+  }
+  
+  Task->Current_PSP--;                       //EXC_RETURN restored by PendSV
+  *(Task->Current_PSP) = 0xFFFFFFFD;         //Thread mode, PSP, basic frame
+  
+  for(uint8 i = 0; i < 8; i++){               //R11 - R4
+    Task->Current_PSP--;
+    *(Task->Current_PSP) = 0x0;
+  }
+}
+
+
+void OS_Port_StartFirstTask(Task_ref* Task){
+  
+  Systick_Start();
+  
+  OS_SET_PSP(Task->Current_PSP);
+  OS_SET_SP_TO_PSP;
+#if (OS_PRIVILEGED_TASKS == 0U)
+  CPUAccess_Unprivileged;
+#endif
+  Task->p_TaskEntry();
+}
+
+
+/* Stretch the SysTick period over Ticks ticks (capped to the 24-bit reload) while only IDLETASK runs */
+void OS_Port_SuppressTicks(uint32 Ticks){
+  
+  uint32 elapsed;
+  
+  if(Ticks > SYSTICK_MAX_PERIOD_MS){
+    Ticks = SYSTICK_MAX_PERIOD_MS;
+  }
+  
+  //Counts already spent in this tick are taken off the stretched period
+  elapsed = NVIC_ST_RELOAD_R - NVIC_ST_CURRENT_R;
+  SysTick_Period_Set(Ticks);
+  NVIC_ST_RELOAD_R -= elapsed;
+  NVIC_ST_CURRENT_R = 0;
+  OS_PortControl.TicklessTicks = Ticks;
+}
+
+/* Go back to the 1 ms period Counts counts after the tick g_tick last counted: returns the
+   whole ticks to credit, the rest of the current tick is kept as the phase of the next one */
+static uint32 OS_Port_TicklessEnd(uint32 Counts){
+  
+  OS_PortControl.TicklessTicks = 0;
+  //The counter takes the shortened reload as CURRENT is cleared, later periods are 1 ms again
+  NVIC_ST_RELOAD_R = SYSTICK_COUNTS_PER_MS - (Counts % SYSTICK_COUNTS_PER_MS);
+  NVIC_ST_CURRENT_R = 0;
+  SysTick_Period_Set(1);
+  return Counts / SYSTICK_COUNTS_PER_MS;
+}
+
+/* Leave a stretched period early (SVC or a kernel call from an interrupt handler): credit
+   exactly what OS_Port_TickCounts reports, so time read before and after never steps back */
+void OS_Port_ResumeTicks(void){
+  
+  uint32 counts;
+  
+  if(OS_PortControl.TicklessTicks == 0){
+    return;
+  }
+  counts = OS_Port_TickCounts();
+  //A wrap still pending is credited here, SysTick_Handler must not count it again
+  SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+  OS_Tick_Advance(OS_Port_TicklessEnd(counts));
+}
+
+uint32 OS_Port_TickCounts(void){
+  
+  uint32 current = NVIC_ST_CURRENT_R;
+  uint32 period = NVIC_ST_RELOAD_R;
+  
+  //A stretched period started part way into a tick: count from that tick, as ResumeTicks does
+  if(OS_PortControl.TicklessTicks != 0){
+    period = OS_PortControl.TicklessTicks * SYSTICK_COUNTS_PER_MS;
+  }
+  //The counter wrapped while SysTick was held off: g_tick is a period behind, and current may
+  //have been read either side of the wrap
+  if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0U){
+    current = NVIC_ST_CURRENT_R;
+    return period + (NVIC_ST_RELOAD_R - current);
+  }
+  return period - current;
+}
+
+
+void SVC_Handler(void){
+  
+#if OS_BENCHMARK
+  uint32 start = OS_PORT_CYCLES();
+#endif
+  
+  __asm("tst lr, #4   \n"
+        "ITE EQ         \n"
+          "mrseq r0, MSP  \n"
+            "mrsne r0, PSP  \n"
+              "mov %0, r0" : "=r" (StackFrame));
+  SVC_Number = *((uint8*)StackFrame[6] - 2);
+  
+  OS_Port_ResumeTicks();
+  OS_SVC_Service(SVC_Number, (uintptr_t*)StackFrame);
+  
+#if OS_BENCHMARK
+  OS_Bench_Record(&OS_Bench_SVCStat, OS_PORT_CYCLES() - start);
+#endif
+}
+
+
+/* Context switch, running at the lowest exception priority so it never needs to mask interrupts.
+   Task frame on the PSP, from the top: hardware frame, s16-s31 (only when EXC_RETURN bit 4 is clear),
+   EXC_RETURN, r11 .. r4. SysTick/SVC may preempt between the NextTask load and the CurrentTask store;
+   they then re-pend PendSV, which tail-chains and switches again. OS_Switch_Hook (run-time statistics,
+   trace) runs once the outgoing task's registers are saved, with interrupts masked from the NextTask
+   load so it charges the task actually switched in and SysTick cannot move StatsStamp under it. */
+__attribute((naked))void PendSV_Handler(void){
+  
+  __asm volatile(
+    "movw   r1, #:lower16:OS_Control    \n\t"
+    "movt   r1, #:upper16:OS_Control    \n\t"
+    "ldr    r2, [r1]                    \n\t"    //r2 = CurrentTask
+    "mrs    r0, PSP                     \n\t"
+#if (__FPU_USED == 1U)
+    "tst    lr, #0x10                   \n\t"
+    "it     eq                          \n\t"
+    "vstmdbeq r0!, {s16-s31}            \n\t"
+#endif
+    "stmdb  r0!, {r4-r11, lr}           \n\t"
+    "str    r0, [r2]                    \n\t"    //CurrentTask->Current_PSP
+#if OS_SWITCH_HOOK
+    "mov    r0, r2                      \n\t"    //r11-r4 and lr are saved: free to call C
+    "cpsid  i                           \n\t"
+    "ldr    r4, [r1, #4]                \n\t"    //r4 = NextTask, kept across the call
+    "str    r4, [r1]                    \n\t"    //CurrentTask = NextTask
+    "mov    r1, r4                      \n\t"
+    "bl     OS_Switch_Hook              \n\t"    //(previous CurrentTask, NextTask)
+    "mov    r2, r4                      \n\t"
+    "cpsie  i                           \n\t"
+#else
+    "ldr    r2, [r1, #4]                \n\t"    //r2 = NextTask
+    "str    r2, [r1]                    \n\t"    //CurrentTask = NextTask
+#endif
+    "ldr    r0, [r2]                    \n\t"
+    "ldmia  r0!, {r4-r11, lr}           \n\t"
+#if (__FPU_USED == 1U)
+    "tst    lr, #0x10                   \n\t"
+    "it     eq                          \n\t"
+    "vldmiaeq r0!, {s16-s31}            \n\t"
+#endif
+    "msr    PSP, r0                     \n\t"
+    "bx     lr                          \n\t"
+  );
+  
+}
+
+
+void SysTick_Handler(void){
+  
+  uint32 ticks = 1;
+#if OS_BENCHMARK
+  uint32 start = OS_PORT_CYCLES();
+#endif
+  
+  if(OS_PortControl.TicklessTicks != 0){
+    //End of a stretched period: count every tick slept and go back to 1 ms, keeping the counts
+    //the counter has run since it wrapped
+    ticks = OS_Port_TicklessEnd((OS_PortControl.TicklessTicks * SYSTICK_COUNTS_PER_MS) + (NVIC_ST_RELOAD_R - NVIC_ST_CURRENT_R));
+  }
+  
+  OS_Tick_Service(ticks);
+  
+#if OS_BENCHMARK
+  OS_Bench_Record(&OS_Bench_TickStat, OS_PORT_CYCLES() - start);
+#endif
+}
+
+#endif
@@ -0,0 +1,257 @@
+#include "Schedular.h"
+#include "OS_Bench.h"
+
+#if defined(OS_PORT_POSIX)
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+static struct{
+  
+  ucontext_t    Contexts[TasksNo];
+  uint32        ContextsNo;
+  sigset_t      TickMask;
+  volatile sig_atomic_t SwitchPending;
+  uint32        CriticalNesting;
+  uint64        LastTick;             /* CLOCK_MONOTONIC ns the last counted tick started at */
+  uint32        TicklessTicks;        /* Ticks covered by the stretched timer period, 0 while ticking */
+  
+}OS_PortControl;
+
+/* Longest stretch, so the ns of OS_Port_TickCounts fit in 32 bits */
+#define OS_POSIX_MAX_STRETCH    1000U
+
+
+static uint64 OS_Posix_Now(void){
+  
+  struct timespec now;
+  
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64)now.tv_sec * 1000000000ULL + (uint64)now.tv_nsec;
+}
+
+
+/* PendSV equivalent, run at the end of every kernel entry with SIGALRM blocked */
+static void OS_Posix_Switch(void){
+  
+  Task_ref* pPrevious;
+  
+  while(OS_PortControl.SwitchPending){
+    OS_PortControl.SwitchPending = 0;
+    pPrevious = OS_Switch_Commit();
+    if(pPrevious != OS_GetCurrentTask()){
+#if OS_SWITCH_HOOK
+      OS_Switch_Hook(pPrevious, OS_GetCurrentTask());
+#endif
+      swapcontext((ucontext_t*)pPrevious->PortContext, (ucontext_t*)OS_GetCurrentTask()->PortContext);
+    }
+  }
+}
+
+/* Next tick signal in First ns, then every 1 ms */
+static void OS_Posix_ArmTick(uint64 First){
+  
+  struct itimerval period;
+  
+  period.it_interval.tv_sec = 0;
+  period.it_interval.tv_usec = 1000;
+  period.it_value.tv_sec = First / 1000000000ULL;
+  period.it_value.tv_usec = (First % 1000000000ULL) / 1000U;
+  if((period.it_value.tv_sec == 0) && (period.it_value.tv_usec == 0)){
+    period.it_value.tv_usec = 1;
+  }
+  setitimer(ITIMER_REAL, &period, NULL);
+}
+
+/* SysTick equivalent */
+static void OS_Posix_TickHandler(int Signal){
+  
+  uint32 ticks = 1;
+#if OS_BENCHMARK
+  uint32 start = OS_PORT_CYCLES();
+#endif
+  
+  (void)Signal;
+  if(OS_PortControl.TicklessTicks != 0){
+    //End of a stretched period: count every tick slept and go back to 1 ms
+    ticks = OS_PortControl.TicklessTicks;
+    OS_PortControl.TicklessTicks = 0;
+    OS_Posix_ArmTick(OS_PORT_TICK_COUNTS);
+  }
+  OS_PortControl.LastTick = OS_Posix_Now();
+  OS_Tick_Service(ticks);
+  
+#if OS_BENCHMARK
+  OS_Bench_Record(&OS_Bench_TickStat, OS_PORT_CYCLES() - start);
+#endif
+  OS_Posix_Switch();
+}
+
+
+void OS_Posix_PendSwitch(void){
+  
+  OS_PortControl.SwitchPending = 1;
+}
+
+/* SVC equivalent: the kernel runs with the tick signal masked, Arg is returned in Args[0] */
+uintptr_t OS_Posix_SVC(uint32 SVC_Number, uintptr_t Arg0, uintptr_t Arg1){
+  
+  uintptr_t args[4] = {Arg0, Arg1, 0, 0};
+  sigset_t previous;
+  
+#if OS_BENCHMARK
+  uint32 start;
+#endif
+  
+  sigprocmask(SIG_BLOCK, &OS_PortControl.TickMask, &previous);
+#if OS_BENCHMARK
+  start = OS_PORT_CYCLES();
+#endif
+  OS_Port_ResumeTicks();
+  OS_SVC_Service(SVC_Number, args);
+#if OS_BENCHMARK
+  OS_Bench_Record(&OS_Bench_SVCStat, OS_PORT_CYCLES() - start);
+#endif
+  OS_Posix_Switch();
+  sigprocmask(SIG_SETMASK, &previous, NULL);
+  
+  return args[0];
+}
+
+void OS_Posix_EnterCritical(sigset_t* State){
+  
+  sigprocmask(SIG_BLOCK, &OS_PortControl.TickMask, State);
+  OS_PortControl.CriticalNesting++;
+}
+
+/* Only the outermost exit takes the switch, like PendSV after the last nested handler */
+void OS_Posix_ExitCritical(const sigset_t* State){
+  
+  if(--OS_PortControl.CriticalNesting == 0){
+    OS_Posix_Switch();
+  }
+  sigprocmask(SIG_SETMASK, State, NULL);
+}
+
+void OS_Posix_WaitForEvent(void){
+  
+  pause();
+}
+
+uint32 OS_Posix_Cycles(void){
+  
+  return (uint32)OS_Posix_Now();
+}
+
+
+void OS_Port_Init(void){
+  
+  sigemptyset(&OS_PortControl.TickMask);
+  sigaddset(&OS_PortControl.TickMask, SIGALRM);
+  sigaddset(&OS_PortControl.TickMask, OS_PORT_POSIX_IRQ_SIGNAL);
+}
+
+
+void OS_Port_InitTaskStack(Task_ref* Task){
+  
+  ucontext_t* pContext = &OS_PortControl.Contexts[OS_PortControl.ContextsNo++];
+  uint32 size = Task->StackSize;
+  
+  if(size < OS_PORT_POSIX_MIN_STACK){
+    size = OS_PORT_POSIX_MIN_STACK;
+  }
+  
+  Task->_E_PSP_Task = (uint32*)malloc(size);
+  Task->_S_PSP_Task = (uint32*)((uint8*)Task->_E_PSP_Task + size);
+  Task->Current_PSP = Task->_S_PSP_Task;
+#if OS_STACK_CHECK
+  for(uint32* pWord = Task->_E_PSP_Task; pWord < Task->_S_PSP_Task; pWord++){
+    *pWord = OS_STACK_PAINT;
+  }
+#endif
+  
+  getcontext(pContext);
+  pContext->uc_stack.ss_sp = Task->_E_PSP_Task;
+  pContext->uc_stack.ss_size = size;
+  pContext->uc_link = NULL;
+  sigemptyset(&pContext->uc_sigmask);
+  makecontext(pContext, Task->p_TaskEntry, 0);
+  Task->PortContext = pContext;
+}
+
+
+/* The static stack is too small for the host, the task gets a ucontext of its own */
+void OS_Port_InitStaticStack(Task_ref* Task){
+  
+  OS_Port_InitTaskStack(Task);
+}
+
+
+void OS_Port_StartFirstTask(Task_ref* Task){
+  
+  struct sigaction action;
+  
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = OS_Posix_TickHandler;
+  sigemptyset(&action.sa_mask);
+  sigaddset(&action.sa_mask, OS_PORT_POSIX_IRQ_SIGNAL);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGALRM, &action, NULL);
+  
+  OS_PortControl.LastTick = OS_Posix_Now();
+  OS_Posix_ArmTick(OS_PORT_TICK_COUNTS);
+  
+  setcontext((ucontext_t*)Task->PortContext);
+}
+
+
+/* Stretch the timer over Ticks ticks while only IDLETASK runs, the part of the current tick
+   already spent is taken off */
+void OS_Port_SuppressTicks(uint32 Ticks){
+  
+  if(Ticks > OS_POSIX_MAX_STRETCH){
+    Ticks = OS_POSIX_MAX_STRETCH;
+  }
+  OS_Posix_ArmTick(((uint64)Ticks * OS_PORT_TICK_COUNTS) - OS_Port_TickCounts());
+  OS_PortControl.TicklessTicks = Ticks;
+}
+
+/* Leave a stretched period early: credit exactly what OS_Port_TickCounts reports and keep the
+   rest of the current tick as the phase of the next one. A SIGALRM already pending is
+   delivered afterwards as an ordinary tick, TickCounts held the time one tick short of it */
+void OS_Port_ResumeTicks(void){
+  
+  uint32 counts;
+  
+  if(OS_PortControl.TicklessTicks == 0){
+    return;
+  }
+  counts = OS_Port_TickCounts();
+  OS_PortControl.TicklessTicks = 0;
+  OS_PortControl.LastTick += (uint64)(counts / OS_PORT_TICK_COUNTS) * OS_PORT_TICK_COUNTS;
+  OS_Posix_ArmTick(OS_PORT_TICK_COUNTS - (counts % OS_PORT_TICK_COUNTS));
+  OS_Tick_Advance(counts / OS_PORT_TICK_COUNTS);
+}
+
+/* Time since the last counted tick; a SIGALRM served late must not carry the time past the
+   ticks the period covers, or it would step back once they are counted */
+uint32 OS_Port_TickCounts(void){
+  
+  uint64 elapsed = OS_Posix_Now() - OS_PortControl.LastTick;
+  uint64 limit = (OS_PortControl.TicklessTicks != 0) ? ((uint64)OS_PortControl.TicklessTicks * OS_PORT_TICK_COUNTS) : OS_PORT_TICK_COUNTS;
+  
+  if(OS_PortControl.LastTick == 0){
+    return 0;                          //Not ticking yet
+  }
+  if(elapsed >= limit){
+    elapsed = limit - 1U;
+  }
+  return (uint32)elapsed;
+}
+
+#endif
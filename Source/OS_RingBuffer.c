@@ -0,0 +1,87 @@
+#include "OS_RingBuffer.h"
+#include "string.h"
+
+
+/* Capacity must be a non-zero power of two; Buffer holds Capacity * ElementSize bytes */
+uint8 OS_RingBufferInit(OS_RingBuffer* pRing, void* Buffer, uint32 ElementSize, uint32 Capacity){
+  
+  if((Buffer == NULL) || (ElementSize == 0U) || (Capacity == 0U) || ((Capacity & (Capacity - 1U)) != 0U)){
+    return OS_RING_INVALID;
+  }
+  pRing->Buffer = (uint8*)Buffer;
+  pRing->ElementSize = ElementSize;
+  pRing->Mask = Capacity - 1U;
+  pRing->Head = 0;
+  pRing->Tail = 0;
+  return OS_RING_OK;
+}
+
+/* Copy Count elements between the ring starting at element Index and pData, in at most two
+   pieces around the end of the buffer */
+static void OS_RingBufferCopy(OS_RingBuffer* pRing, uint32 Index, uint8* pData, uint32 Count, boolean ToRing){
+  
+  uint32 first = (pRing->Mask + 1U) - Index;
+  uint8* pSlot = &pRing->Buffer[Index * pRing->ElementSize];
+  
+  if(first > Count){
+    first = Count;
+  }
+  if(ToRing){
+    memcpy(pSlot, pData, first * pRing->ElementSize);
+    memcpy(pRing->Buffer, pData + first * pRing->ElementSize, (Count - first) * pRing->ElementSize);
+  }
+  else{
+    memcpy(pData, pSlot, first * pRing->ElementSize);
+    memcpy(pData + first * pRing->ElementSize, pRing->Buffer, (Count - first) * pRing->ElementSize);
+  }
+}
+
+/* Producer side: write up to Count elements, returns how many fitted */
+uint32 OS_RingBufferWrite(OS_RingBuffer* pRing, const void* pData, uint32 Count){
+  
+  uint32 head = pRing->Head;
+  uint32 space = (pRing->Mask + 1U) - (head - pRing->Tail);
+  
+  if(Count > space){
+    Count = space;
+  }
+  if(Count == 0U){
+    return 0;
+  }
+  OS_RingBufferCopy(pRing, head & pRing->Mask, (uint8*)pData, Count, TRUE);
+  //Elements must be in memory before the consumer can see the new Head
+  OS_PORT_MEMORY_BARRIER();
+  pRing->Head = head + Count;
+  return Count;
+}
+
+/* Consumer side: read up to Count elements, returns how many were available */
+uint32 OS_RingBufferRead(OS_RingBuffer* pRing, void* pData, uint32 Count){
+  
+  uint32 tail = pRing->Tail;
+  uint32 available = pRing->Head - tail;
+  
+  if(Count > available){
+    Count = available;
+  }
+  if(Count == 0U){
+    return 0;
+  }
+  //Head was read before the elements it covers
+  OS_PORT_MEMORY_BARRIER();
+  OS_RingBufferCopy(pRing, tail & pRing->Mask, (uint8*)pData, Count, FALSE);
+  //Copied out before the producer may reuse the slots
+  OS_PORT_MEMORY_BARRIER();
+  pRing->Tail = tail + Count;
+  return Count;
+}
+
+uint32 OS_RingBufferCount(const OS_RingBuffer* pRing){
+  
+  return pRing->Head - pRing->Tail;
+}
+
+uint32 OS_RingBufferSpace(const OS_RingBuffer* pRing){
+  
+  return (pRing->Mask + 1U) - (pRing->Head - pRing->Tail);
+}
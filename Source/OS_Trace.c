@@ -0,0 +1,120 @@
+#include "OS_Trace.h"
+
+#if OS_TRACE
+
+OS_TraceBuffer OS_Trace = {
+  .Header = {
+    .Magic = OS_TRACE_MAGIC,
+    .Version = OS_TRACE_VERSION,
+    .Mode = OS_TRACE_OFF,
+    .EventSize = sizeof(OS_TraceEvent),
+    .TaskCount = TasksNo,
+    .Capacity = OS_TRACE_EVENTS
+  }
+};
+
+static boolean OS_Trace_HeaderSent;
+
+
+/* Reserve a slot without masking interrupts; Type is stored last so readers skip a slot that
+   an interrupted writer has not finished */
+void OS_Trace_Record(uint8 Type, uint8 Task, uint16 Arg){
+  
+  OS_TraceEvent* pEvent;
+  uint32 slot;
+  
+  if(OS_Trace.Header.Mode == OS_TRACE_OFF){
+    return;
+  }
+  
+  //The full check and the reservation are one step: an interrupt that records in between makes
+  //the CAS fail and the check runs again on the new Head
+  do{
+    slot = *(volatile uint32*)&OS_Trace.Header.Head;
+    if((OS_Trace.Header.Mode == OS_TRACE_STREAM) && ((slot - *(volatile uint32*)&OS_Trace.Header.Tail) >= OS_TRACE_EVENTS)){
+      (void)OS_PORT_ATOMIC_INC(&OS_Trace.Header.Dropped);
+      return;
+    }
+  }while(!OS_PORT_ATOMIC_CAS(&OS_Trace.Header.Head, slot, slot + 1U));
+  
+  pEvent = &OS_Trace.Events[slot & (OS_TRACE_EVENTS - 1U)];
+  pEvent->Type = 0;
+  pEvent->Timestamp = OS_PORT_CYCLES();
+  pEvent->Task = Task;
+  pEvent->Arg = Arg;
+  OS_PORT_MEMORY_BARRIER();
+  pEvent->Type = Type;
+}
+
+/* Name the task's trace id in the header, called as the kernel registers it */
+void OS_Trace_AddTask(Task_ref* Task, uint32 Index){
+  
+  Task->TraceId = (uint8)Index;
+  for(uint32 i = 0; i < OS_TRACE_NAME_LENGTH - 1U; i++){
+    OS_Trace.Header.TaskNames[Index][i] = Task->TaskName[i];
+    if(Task->TaskName[i] == '\0'){
+      break;
+    }
+  }
+}
+
+void OS_Trace_Start(uint8 Mode){
+  
+  OS_Trace.Header.Mode = OS_TRACE_OFF;
+  OS_Trace.Header.Head = 0;
+  OS_Trace.Header.Tail = 0;
+  OS_Trace.Header.Dropped = 0;
+  OS_Trace.Header.CyclesPerSecond = OS_PORT_CYCLES_PER_SECOND;
+  OS_Trace_HeaderSent = FALSE;
+  for(uint32 i = 0; i < OS_TRACE_EVENTS; i++){
+    OS_Trace.Events[i].Type = 0;
+  }
+  OS_PORT_MEMORY_BARRIER();
+  OS_Trace.Header.Mode = Mode;
+}
+
+/* Freeze a snapshot, e.g. from the fault or error path that should be explained */
+void OS_Trace_Stop(void){
+  
+  OS_Trace.Header.Mode = OS_TRACE_OFF;
+}
+
+/* Header marked as a snapshot, then the whole ring */
+void OS_Trace_Dump(void(*Write)(const void* Data, uint32 Length)){
+  
+  OS_TraceHeader header = OS_Trace.Header;
+  
+  header.Mode = OS_TRACE_SNAPSHOT;
+  Write(&header, sizeof(header));
+  Write(OS_Trace.Events, sizeof(OS_Trace.Events));
+}
+
+/* Stream mode: pass the completed events to Write in order, header first; returns the count */
+uint32 OS_Trace_Drain(void(*Write)(const void* Data, uint32 Length)){
+  
+  OS_TraceEvent* pEvent;
+  uint32 count = 0;
+  
+  if(OS_Trace.Header.Mode != OS_TRACE_STREAM){
+    return 0;
+  }
+  if(!OS_Trace_HeaderSent){
+    Write(&OS_Trace.Header, sizeof(OS_Trace.Header));
+    OS_Trace_HeaderSent = TRUE;
+  }
+  
+  while(OS_Trace.Header.Tail != OS_Trace.Header.Head){
+    pEvent = &OS_Trace.Events[OS_Trace.Header.Tail & (OS_TRACE_EVENTS - 1U)];
+    if(pEvent->Type == 0){
+      break;
+    }
+    Write(pEvent, sizeof(*pEvent));
+    pEvent->Type = 0;
+    OS_PORT_MEMORY_BARRIER();
+    OS_Trace.Header.Tail++;
+    count++;
+  }
+  return count;
+}
+
+#endif
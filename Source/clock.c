@@ -0,0 +1,145 @@
+/****************************************************************************************************/
+/* Module Name : clock ( source file )                                                              */
+/*                                                                                                  */
+/* Author      : Team 1                                                                             */
+/*                                                                                                  */
+/* Purpose     : This source file implements the functions declared in "clock.h". It                */
+/*               switches the system clock between the 16 MHz main oscillator and the               */
+/*               400 MHz PLL divided down to 80 MHz or below, and keeps SystemCoreClock             */
+/*               and SysTick in step with it.                                                       */
+/*                                                                                                  */
+/****************************************************************************************************/
+
+
+
+#include "ARMCM4.h"
+#include "tm4c123gh6pm.h"
+#include "bitwise_operation.h"
+#include "clock.h"
+#include "systick.h"
+#include "OS_Trace.h"
+
+
+/*********************************************Functions***********************************************/
+
+/****************************************************************************************************/
+/* Function Name :  Clock_Init                                                                      */
+/* Inputs        :  void ( No inputs  )                                                             */
+/* Outputs       :  void ( No outputs )                                                             */
+/* Reentrancy    :  Non Reentrant                                                                   */
+/* Synchronous   :  Synchronous                                                                     */
+/* Description   :  This function sets the system clock to CLOCK_SYSTEM_HZ. It is called by         */
+/*                  OS_Port_Init before anything reads SystemCoreClock.                             */
+/****************************************************************************************************/
+void Clock_Init(void){
+  
+  (void)Clock_Set(CLOCK_SYSTEM_HZ);
+}
+
+
+
+/****************************************************************************************************/
+/* Function Name :  Clock_Set                                                                       */
+/* Inputs        :  uint32 ( frequency_hz )                                                         */
+/* Outputs       :  uint8  ( CLOCK_OK / CLOCK_INVALID )                                             */
+/* Reentrancy    :  Non Reentrant                                                                   */
+/* Synchronous   :  Synchronous                                                                     */
+/* Description   :  This function runs the core at frequency_hz: CLOCK_XTAL_HZ straight from        */
+/*                  the main oscillator, otherwise from the PLL at the fastest 400 MHz / n not      */
+/*                  above frequency_hz, between CLOCK_MIN_HZ and CLOCK_MAX_HZ. SystemCoreClock      */
+/*                  is updated and a running SysTick is reloaded for the same period at the new     */
+/*                  clock, the period in progress rescaled so it keeps its phase. Privileged code   */
+/*                  only: main, handlers or OS_PRIVILEGED_TASKS.                                    */
+/*                  A running OS_TRACE should be restarted after a change (OS_Trace.h).             */
+/****************************************************************************************************/
+uint8 Clock_Set(uint32 frequency_hz){
+  
+  uint32 primask;
+  uint32 divider = 0;
+  uint32 tick_ms = 0;
+  uint32 old_counts = SYSTICK_COUNTS_PER_MS;
+  uint32 remaining;
+  
+  if(frequency_hz != CLOCK_XTAL_HZ){
+    if((frequency_hz > CLOCK_MAX_HZ) || (frequency_hz < CLOCK_MIN_HZ)){
+      return CLOCK_INVALID;
+    }
+    divider = (CLOCK_PLL_HZ + frequency_hz - 1U) / frequency_hz;
+  }
+  
+  primask = __get_PRIMASK();
+  __disable_irq();
+  
+  /* Tick period in ms at the old clock, to be kept at the new one. A stretched tickless period
+     is ended first, through the kernel, so the ticks it covered so far are counted at the clock
+     they ran at and the tasks they wake are scheduled */
+  if(GET_BIT(NVIC_ST_CTRL_R,0)){
+    OS_TickSync();
+    tick_ms = NVIC_ST_RELOAD_R / SYSTICK_COUNTS_PER_MS;
+    if(tick_ms == 0U){
+      tick_ms = 1;
+    }
+    if(tick_ms > SYSTICK_MAX_PERIOD_MS){
+      tick_ms = SYSTICK_MAX_PERIOD_MS;
+    }
+  }
+  
+  /* RCC2  : bit 31 USERCC2 --> RCC2 fields override RCC */
+  /* BYPASS2 : run from the oscillator while the PLL and its divider are changed */
+  SYSCTL_RCC2_R |= SYSCTL_RCC2_USERCC2 | SYSCTL_RCC2_BYPASS2;
+  
+  /* Main oscillator on, 16 MHz crystal, selected as the PLL and bypass source */
+  SYSCTL_RCC_R &= ~SYSCTL_RCC_MOSCDIS;
+  while((SYSCTL_RIS_R & SYSCTL_RIS_MOSCPUPRIS) == 0U){}
+  SYSCTL_RCC_R = (SYSCTL_RCC_R & ~SYSCTL_RCC_XTAL_M) | SYSCTL_RCC_XTAL_16MHZ;
+  SYSCTL_RCC2_R &= ~SYSCTL_RCC2_OSCSRC2_M;
+  
+  if(divider == 0U){
+    /* Undivided main oscillator: the PLL stays bypassed and is powered down */
+    SYSCTL_RCC_R &= ~SYSCTL_RCC_USESYSDIV;
+    SYSCTL_RCC2_R |= SYSCTL_RCC2_PWRDN2;
+  }
+  else{
+    /* PLL on, 400 MHz output divided by SYSDIV2:SYSDIV2LSB + 1, then wait for the lock */
+    SYSCTL_RCC2_R &= ~SYSCTL_RCC2_PWRDN2;
+    SYSCTL_RCC2_R |= SYSCTL_RCC2_DIV400;
+    SYSCTL_RCC2_R = (SYSCTL_RCC2_R & ~(SYSCTL_RCC2_SYSDIV2_M | SYSCTL_RCC2_SYSDIV2LSB)) | ((divider - 1U) << 22);
+    SYSCTL_RCC_R |= SYSCTL_RCC_USESYSDIV;
+    while((SYSCTL_PLLSTAT_R & SYSCTL_PLLSTAT_LOCK) == 0U){}
+    SYSCTL_RCC2_R &= ~SYSCTL_RCC2_BYPASS2;
+  }
+  SystemCoreClockUpdate();
+  
+  /* Re-derive the tick from the new SystemCoreClock. The part of the current period still to
+     run is rescaled to the new clock and loaded through RELOAD as CURRENT is cleared, so the
+     tick keeps its phase and OS_GetTimeUs does not step back */
+  if(tick_ms != 0U){
+    remaining = (uint32)(((uint64)NVIC_ST_CURRENT_R * SYSTICK_COUNTS_PER_MS) / old_counts);
+    NVIC_ST_RELOAD_R = (remaining != 0U) ? remaining : 1U;
+    NVIC_ST_CURRENT_R = 0;
+    SysTick_Period_Set(tick_ms);
+  }
+  
+#if OS_TRACE
+  //Later timestamps count at the new rate (see OS_Trace.h for the events recorded before)
+  OS_Trace.Header.CyclesPerSecond = SystemCoreClock;
+#endif
+  
+  __set_PRIMASK(primask);
+  return CLOCK_OK;
+}
+
+
+
+/****************************************************************************************************/
+/* Function Name :  Clock_Get                                                                       */
+/* Inputs        :  void   ( No inputs  )                                                           */
+/* Outputs       :  uint32 ( SystemCoreClock )                                                      */
+/* Reentrancy    :  Reentrant                                                                       */
+/* Synchronous   :  Synchronous                                                                     */
+/* Description   :  This function returns the current core clock frequency in Hz.                   */
+/****************************************************************************************************/
+uint32 Clock_Get(void){
+  
+  return SystemCoreClock;
+}
@@ -68,6 +68,16 @@ void Interrupt6_Handler     (void) __attribute__ ((weak, alias("Default_Handler"
 void Interrupt7_Handler     (void) __attribute__ ((weak, alias("Default_Handler")));
 void Interrupt8_Handler     (void) __attribute__ ((weak, alias("Default_Handler")));
 void Interrupt9_Handler     (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt10_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt11_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt12_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt13_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt14_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt15_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt16_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt17_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt18_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
+void Interrupt19_Handler    (void) __attribute__ ((weak, alias("Default_Handler")));
 
 
 /*----------------------------------------------------------------------------
@@ -108,8 +118,18 @@ extern const VECTOR_TABLE_Type __VECTOR_TABLE[240];
   Interrupt6_Handler,                       /*   6 Interrupt 6 */
   Interrupt7_Handler,                       /*   7 Interrupt 7 */
   Interrupt8_Handler,                       /*   8 Interrupt 8 */
-  Interrupt9_Handler                        /*   9 Interrupt 9 */
-                                            /* Interrupts 10 .. 223 are left out */
+  Interrupt9_Handler,                       /*   9 Interrupt 9 */
+  Interrupt10_Handler,                      /*  10 Interrupt 10 */
+  Interrupt11_Handler,                      /*  11 Interrupt 11 */
+  Interrupt12_Handler,                      /*  12 Interrupt 12 */
+  Interrupt13_Handler,                      /*  13 Interrupt 13 */
+  Interrupt14_Handler,                      /*  14 Interrupt 14 */
+  Interrupt15_Handler,                      /*  15 Interrupt 15 */
+  Interrupt16_Handler,                      /*  16 Interrupt 16 */
+  Interrupt17_Handler,                      /*  17 Interrupt 17 */
+  Interrupt18_Handler,                      /*  18 Interrupt 18 */
+  Interrupt19_Handler                       /*  19 Interrupt 19 (TM4C123: 16/32-bit Timer 0A) */
+                                            /* Interrupts 20 .. 223 are left out */
 };
 
 #if defined ( __GNUC__ )
@@ -31,13 +31,14 @@
 #else
   #error device not specified!
 #endif
+#include "tm4c123gh6pm.h"
 
 /*----------------------------------------------------------------------------
   Define clocks
  *----------------------------------------------------------------------------*/
-#define  XTAL            (50000000UL)     /* Oscillator frequency */
+#define  XTAL            (16000000UL)     /* PIOSC, the TM4C123 clock out of reset */
 
-#define  SYSTEM_CLOCK    (XTAL / 2U)
+#define  SYSTEM_CLOCK    (XTAL)           /* Raised by Clock_Init (clock.c) */
 
 /*----------------------------------------------------------------------------
   Exception / Interrupt Vector table
@@ -52,11 +53,55 @@ uint32_t SystemCoreClock = SYSTEM_CLOCK;  /* System Core Clock Frequency */
 
 
 /*----------------------------------------------------------------------------
-  System Core Clock update function
+  Main oscillator frequencies of the RCC XTAL field, from 0x06 (4 MHz) on
+ *----------------------------------------------------------------------------*/
+static const uint32_t XtalFrequency[] = {
+   4000000UL,  4096000UL,  4915200UL,  5000000UL,  5120000UL,  6000000UL,  6144000UL,
+   7372800UL,  8000000UL,  8192000UL, 10000000UL, 12000000UL, 12288000UL, 13560000UL,
+  14318180UL, 16000000UL, 16384000UL, 18000000UL, 20000000UL, 24000000UL, 25000000UL
+};
+
+
+/*----------------------------------------------------------------------------
+  System Core Clock update function: decodes RCC/RCC2 as left by Clock_Set
  *----------------------------------------------------------------------------*/
 void SystemCoreClockUpdate (void)
 {
-  SystemCoreClock = SYSTEM_CLOCK;
+  uint32_t rcc = SYSCTL_RCC_R;
+  uint32_t rcc2 = SYSCTL_RCC2_R;
+  uint32_t useRcc2 = ((rcc2 & SYSCTL_RCC2_USERCC2) != 0U);
+  uint32_t source = useRcc2 ? ((rcc2 & SYSCTL_RCC2_OSCSRC2_M) >> 4) : ((rcc & SYSCTL_RCC_OSCSRC_M) >> 4);
+  uint32_t bypass = useRcc2 ? (rcc2 & SYSCTL_RCC2_BYPASS2) : (rcc & SYSCTL_RCC_BYPASS);
+  uint32_t xtal = (rcc & SYSCTL_RCC_XTAL_M) >> 6;
+  uint32_t clock;
+  uint32_t divider;
+
+  switch (source)
+  {
+    case 0U:  clock = ((xtal >= 0x06U) && (xtal <= 0x1AU)) ? XtalFrequency[xtal - 0x06U] : XTAL; break;
+    case 1U:  clock = 16000000UL; break;              /* PIOSC */
+    case 2U:  clock =  4000000UL; break;              /* PIOSC / 4 */
+    case 3U:  clock =     30000UL; break;             /* LFIOSC, nominal */
+    default:  clock =     32768UL; break;             /* Hibernation oscillator */
+  }
+
+  if (bypass == 0U)
+  {
+    /* PLL: 400 MHz, halved unless RCC2 DIV400 keeps it for SYSDIV2:SYSDIV2LSB */
+    if (useRcc2 && ((rcc2 & SYSCTL_RCC2_DIV400) != 0U))
+    {
+      SystemCoreClock = 400000000UL / (((rcc2 >> 22) & 0x7FU) + 1U);      /* SYSDIV2:SYSDIV2LSB */
+      return;
+    }
+    clock = 200000000UL;
+  }
+
+  if ((rcc & SYSCTL_RCC_USESYSDIV) != 0U || (bypass == 0U))
+  {
+    divider = useRcc2 ? ((rcc2 & SYSCTL_RCC2_SYSDIV2_M) >> SYSCTL_RCC2_SYSDIV2_S) : ((rcc & SYSCTL_RCC_SYSDIV_M) >> SYSCTL_RCC_SYSDIV_S);
+    clock /= (divider + 1U);
+  }
+  SystemCoreClock = clock;
 }
 
 /*----------------------------------------------------------------------------
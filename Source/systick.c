@@ -99,13 +99,13 @@ void SysTick_Enable(void){
 /* Reentrancy    :  Reentrant																		 */
 /* Synchronous   :  Asynchronous						   											 */
 /* Description   :	This function calculates and returns the elapsed time in milliseconds by dividing*/ 
-/* 					the current value of the SysTick timer by the assumed clock frequency (16000 Hz) */
+/* 					the current value of the SysTick timer by the counts per millisecond              */
 /*****************************************************************************************************/
 uint32 SysTick_Period_Get(void){
 	
   /* Systick Value : SysTick Current Value Register	*/
-  /* bits 0:23    : Curretnt value running /16000	*/
-  return NVIC_ST_CURRENT_R / 16000;
+  /* bits 0:23    : Curretnt value running /SYSTICK_COUNTS_PER_MS*/
+  return NVIC_ST_CURRENT_R / SYSTICK_COUNTS_PER_MS;
 }
 
 
@@ -125,8 +125,8 @@ uint32 SysTick_Period_Get(void){
 void SysTick_Period_Set(uint32 time_ms){
 	
   /* Reload Value : SysTick Reload Value Register */
-  /* bits 0:23    : Systick reload value* 16000	  */
-  NVIC_ST_RELOAD_R = time_ms*16000;
+  /* bits 0:23    : Systick reload value* SYSTICK_COUNTS_PER_MS*/
+  NVIC_ST_RELOAD_R = time_ms*SYSTICK_COUNTS_PER_MS;
 }
 
 
@@ -144,7 +144,7 @@ void SysTick_Period_Set(uint32 time_ms){
 uint32 SysTick_Value_Get(void){
 
   /* Systick Value : SysTick Current Value Register	*/
-  /*bits 0:23    : Curretnt value running /16000	*/	
+  /*bits 0:23    : Curretnt value running		*/	
   return NVIC_ST_CURRENT_R;
 }
 
@@ -241,13 +241,13 @@ void SysTick_Delay (uint32 n)
 /* Description   :	This function utilizes the SysTick_Delay function to implement a delay of the	 */
 /*					specified duration in milliseconds. It loops 'delay' times, each time invoking   */
 /*					SysTick_Delay with a parameter equivalent to 1 millisecond  					 */
-/*					(16000 SysTick timer ticks).											     	 */
+/*					(SYSTICK_COUNTS_PER_MS counts).											     	 */
 /*****************************************************************************************************/
 void SysTick_1ms (uint32 delay)
 {
   // Call for systick delay function to apply 1 ms delay
   for(int i=0;i<delay;i++){
-    SysTick_Delay(16000);
+    SysTick_Delay(SYSTICK_COUNTS_PER_MS);
   }
 }
 
@@ -261,7 +261,7 @@ void SysTick_1ms (uint32 delay)
 /* Synchronous   :  Asynchronous																	 */
 /* Description   :	This function configures the SysTick timer by clearing control bits, reloading	 */
 /*					the timer, and setting the initial value. The reload value is set to achieve     */
-/*					a 1 ms period based on the assumption that the CPU frequency is 16 MHz.          */
+/*					a 1 ms period from the core clock published in SystemCoreClock.                  */
 /*					The function then enables the SysTick timer and sets its priority level.		 */
 /*****************************************************************************************************/
 void Systick_Start(void)
@@ -298,7 +298,7 @@ void Systick_Start(void)
   /* bits 16 = 0 --> The SysTick timer has not counted to 0 since the last time this bit was read	*/
   /* bits 16 = 1 --> The SysTick timer has counted to 0 since the last time this bit was read.		*/
   if(GET_BIT(NVIC_ST_CTRL_R,16)){}; 
-  NVIC_ST_RELOAD_R = 1 *16000;  //Set the Reload Value (16000 to get 1 ms as CPU_Freq = 16MHz)
+  NVIC_ST_RELOAD_R = 1 *SYSTICK_COUNTS_PER_MS;  //Set the Reload Value (SYSTICK_COUNTS_PER_MS to get 1 ms)
   
   /* Enable SysTick   */
   /* Clock Source : SysTick Control and Status Register					*/
@@ -0,0 +1,114 @@
+/*
+ * Host test of OS_GetTimeUs across tickless idle, built instead of main.c and OS_Cfg.c:
+ *   gcc -DOS_PORT_POSIX -IIncludes Tests/OS_Test_Time.c Source/OS.c Source/OS_Port_Posix.c -lrt -o os_test_time
+ *
+ * The only task waits with a timeout, so the port stretches the tick over the idle time, and a
+ * host timer signal standing for an application interrupt reads the time and wakes the task
+ * part way through the stretch. Every value read, by the task or the interrupt, must be at
+ * least the one read before it. Exits with 0 on success.
+ */
+
+#include "Schedular.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TEST_WAIT_TICKS         7U
+#define TEST_IRQ_PERIOD_NS      2300000L
+#define TEST_DURATION_TICKS     2000U
+
+void Test_Waiter(void);
+
+Task_ref Test_WaiterTask = {
+  .StackSize = 512,
+  .Priority = 2,
+  .p_TaskEntry = Test_Waiter,
+  .TimingWaiting.Blocking = BlockingDisabled,
+  .TaskName = "Waiter"
+};
+
+static volatile uint64 Test_Last;
+static volatile uint32 Test_Reads;
+static volatile uint32 Test_Backwards;
+static volatile uint32 Test_EarlyWakes;
+static volatile uint32 Test_Timeouts;
+static sigset_t Test_IrqMask;
+
+/* Read the time and compare it with the latest value read anywhere */
+static void Test_Check(void){
+  
+  uint64 now = OS_GetTimeUs();
+  
+  if(now < Test_Last){
+    Test_Backwards++;
+    printf("time stepped back: %llu after %llu\n", (unsigned long long)now, (unsigned long long)Test_Last);
+  }
+  Test_Last = now;
+  Test_Reads++;
+}
+
+/* Application interrupt: reads around an early end of the stretched tick */
+static void Test_Irq(int Signal){
+  
+  (void)Signal;
+  Test_Check();
+  if(Test_WaiterTask.TaskState == Waiting){
+    Test_EarlyWakes++;
+  }
+  OS_TaskNotify(&Test_WaiterTask, 1, OS_NOTIFY_SET_BITS);
+  Test_Check();
+}
+
+void Test_Waiter(void){
+  
+  uint32 value;
+  sigset_t previous;
+  
+  while(OS_GetTime() < TEST_DURATION_TICKS){
+    if(OS_TaskNotifyWait(0xFFFFFFFFU, TEST_WAIT_TICKS, &value) != OS_WAIT_OK){
+      Test_Timeouts++;
+    }
+    //Keep the interrupt out between the read and the comparison
+    sigprocmask(SIG_BLOCK, &Test_IrqMask, &previous);
+    Test_Check();
+    sigprocmask(SIG_SETMASK, &previous, NULL);
+  }
+  
+  printf("reads=%u early_wakes=%u timeouts=%u backwards=%u\n", Test_Reads, Test_EarlyWakes, Test_Timeouts, Test_Backwards);
+  exit(((Test_Backwards == 0) && (Test_EarlyWakes != 0)) ? 0 : 1);
+}
+
+
+int main(void){
+  
+  struct sigaction action;
+  struct sigevent event;
+  struct itimerspec period = {{0, TEST_IRQ_PERIOD_NS}, {0, TEST_IRQ_PERIOD_NS}};
+  timer_t timer;
+  
+  sigemptyset(&Test_IrqMask);
+  sigaddset(&Test_IrqMask, OS_PORT_POSIX_IRQ_SIGNAL);
+  
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = Test_Irq;
+  sigemptyset(&action.sa_mask);
+  sigaddset(&action.sa_mask, SIGALRM);
+  sigaction(OS_PORT_POSIX_IRQ_SIGNAL, &action, NULL);
+  
+  memset(&event, 0, sizeof(event));
+  event.sigev_notify = SIGEV_SIGNAL;
+  event.sigev_signo = OS_PORT_POSIX_IRQ_SIGNAL;
+  timer_create(CLOCK_MONOTONIC, &event, &timer);
+  timer_settime(timer, 0, &period, NULL);
+  
+  OS_Init();
+  OS_CreateTask(&Test_WaiterTask);
+  OS_Start();
+  
+  while(1){
+  
+  }
+}
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+Offline schedulability analysis of the Tasks_Configuration table in Source/OS_Cfg.c.
+
+Response-time analysis for the fixed-priority scheduler (lower Priority value = higher
+priority, equal priorities share the CPU round robin), with
+  - blocking from mutexes under priority inheritance: one critical section per resource
+    that a lower-priority task can hold while a task of this priority or higher uses it,
+  - kernel overhead: SysTick_Handler once per tick, and per job one SVC plus two context
+    switches, taken from the OS_Bench report (Bench/OS_Bench_Main.c) when one is given.
+
+Usage:
+  python3 Tools/os_rta.py --wcet wcet.txt [--config Source/OS_Cfg.c] [--bench bench.txt]
+                          [--cpu-hz 80000000] [--tick-us 1000]
+
+WCET file, one entry per line (times in microseconds, '#' starts a comment):
+  task  <TaskName> <wcet_us> [period_ticks] [deadline_ticks]
+  cs    <TaskName> <resource> <critical_section_us>
+Tasks missing from the file are reported but left out of the analysis. Period defaults to
+TimingWaiting.Ticks_Count (the minimum inter-arrival time for event-driven tasks), the
+deadline to the period.
+
+Also usable as a library: parse_config(), parse_wcet(), parse_bench(), analyse().
+"""
+
+import argparse
+import math
+import re
+import sys
+
+
+class Task:
+
+    def __init__(self, name, priority, period):
+        self.name = name
+        self.priority = priority
+        self.period = period            # ticks
+        self.deadline = period          # ticks
+        self.wcet = None                # us
+        self.sections = {}              # resource -> longest critical section, us
+        self.response = None            # us, None when the task does not converge
+        self.blocking = 0.0             # us
+
+
+def parse_config(path):
+    """Tasks of Tasks_Configuration, in table order."""
+    text = open(path).read()
+    start = text.find("Tasks_Configuration")
+    if start < 0:
+        raise ValueError("%s: no Tasks_Configuration" % path)
+    tasks = []
+    for block in re.findall(r"\{([^{}]*\.p_TaskEntry[^{}]*)\}", text[start:]):
+        fields = dict(re.findall(r"\.([\w.]+)\s*=\s*([^,\n]+)", block))
+        name = fields.get("TaskName", '"?"').strip().strip('"')
+        priority = int(fields["Priority"].rstrip("uU"), 0)
+        period = int(fields.get("TimingWaiting.Ticks_Count", "0").rstrip("uU"), 0)
+        tasks.append(Task(name, priority, period))
+    return tasks
+
+
+def parse_wcet(path, tasks):
+    byname = {t.name: t for t in tasks}
+    for number, line in enumerate(open(path), 1):
+        words = line.split("#", 1)[0].split()
+        if not words:
+            continue
+        task = byname.get(words[1]) if len(words) > 1 else None
+        if task is None:
+            raise ValueError("%s:%d: unknown task" % (path, number))
+        if words[0] == "task":
+            task.wcet = float(words[2])
+            if len(words) > 3:
+                task.period = task.deadline = int(words[3])
+            if len(words) > 4:
+                task.deadline = int(words[4])
+        elif words[0] == "cs":
+            task.sections[words[2]] = max(task.sections.get(words[2], 0.0), float(words[3]))
+        else:
+            raise ValueError("%s:%d: expected 'task' or 'cs'" % (path, number))
+
+
+def parse_bench(path, cpu_hz=None):
+    """Worst-case kernel costs in us from an OS_Bench report: tick, SVC and context switch.
+    Cycles are converted at cpu_hz when given, else at the report's clock= rate, else 80 MHz."""
+    lines = open(path).read().splitlines()
+    for line in lines:
+        match = re.search(r"clock=(\d+) cycles/s", line)
+        if match is not None and cpu_hz is None:
+            cpu_hz = float(match.group(1))
+    scale = 1e6 / (cpu_hz or 80e6)
+    costs = {"tick": 0.0, "svc": 0.0, "switch": 0.0}
+    for line in lines:
+        match = re.search(r"([\w-]+): n=\d+ min=\d+ avg=\d+ max=(\d+) (\w+)", line)
+        if match is None:
+            continue
+        value = int(match.group(2)) * (1e-3 if match.group(3) == "ns" else scale)
+        name = match.group(1)
+        if name == "SysTick_Handler":
+            costs["tick"] = max(costs["tick"], value)
+        elif name == "SVC_Handler":
+            costs["svc"] = max(costs["svc"], value)
+        elif name == "activate-to-run":
+            costs["switch"] = max(costs["switch"], value)
+    return costs
+
+
+def analyse(tasks, tick_us=1000.0, costs=None):
+    """Fill in blocking and worst-case response time (us) of every task with a WCET."""
+    costs = costs or {"tick": 0.0, "svc": 0.0, "switch": 0.0}
+    known = [t for t in tasks if t.wcet is not None and t.period > 0]
+    job_overhead = costs["svc"] + 2.0 * costs["switch"]
+
+    # Priority ceiling of every resource: the highest priority among its users
+    ceiling = {}
+    for t in known:
+        for resource in t.sections:
+            ceiling[resource] = min(ceiling.get(resource, t.priority), t.priority)
+
+    for task in known:
+        task.blocking = 0.0
+        for resource, top in ceiling.items():
+            if top > task.priority:
+                continue
+            lower = [t.sections[resource] for t in known if t.priority > task.priority and resource in t.sections]
+            task.blocking += max(lower, default=0.0)
+
+        interferers = [t for t in known if t is not task and t.priority <= task.priority]
+        own = task.wcet + job_overhead + task.blocking
+        limit = task.deadline * tick_us
+        response = own
+        while True:
+            demand = own + math.ceil(response / tick_us) * costs["tick"]
+            for other in interferers:
+                demand += math.ceil(response / (other.period * tick_us)) * (other.wcet + job_overhead)
+            if demand == response or demand > limit * 4:
+                break
+            response = demand
+        task.response = demand if demand <= limit * 4 else None
+    return known
+
+
+def report(tasks, known, tick_us, costs):
+    utilisation = sum((t.wcet + costs["svc"] + 2.0 * costs["switch"]) / (t.period * tick_us) for t in known)
+    utilisation += costs["tick"] / tick_us
+    print("kernel: tick %.2f us, SVC %.2f us, switch %.2f us" % (costs["tick"], costs["svc"], costs["switch"]))
+    print("utilisation: %.1f %%" % (100.0 * utilisation))
+    print("%-16s %4s %8s %10s %10s %10s %10s  %s" % ("task", "prio", "period", "wcet_us", "block_us", "wcrt_us", "slack_us", "result"))
+    schedulable = True
+    for t in sorted(tasks, key=lambda t: t.priority):
+        if t not in known:
+            print("%-16s %4d %8d %10s %10s %10s %10s  %s" % (t.name, t.priority, t.period, "-", "-", "-", "-", "no WCET"))
+            continue
+        limit = t.deadline * tick_us
+        if t.response is None:
+            print("%-16s %4d %8d %10.1f %10.1f %10s %10s  %s" % (t.name, t.priority, t.period, t.wcet, t.blocking, "inf", "-", "MISS"))
+            schedulable = False
+            continue
+        ok = t.response <= limit
+        schedulable = schedulable and ok
+        print("%-16s %4d %8d %10.1f %10.1f %10.1f %10.1f  %s" % (t.name, t.priority, t.period, t.wcet, t.blocking,
+                                                              t.response, limit - t.response, "ok" if ok else "MISS"))
+    print("task set %s" % ("schedulable" if schedulable else "NOT schedulable"))
+    return schedulable
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--config", default="Source/OS_Cfg.c")
+    parser.add_argument("--wcet", required=True)
+    parser.add_argument("--bench", help="OS_Bench report captured from UART0 or the host port")
+    parser.add_argument("--cpu-hz", type=float, help="core clock the bench cycles were taken at "
+                        "(default: the report's clock= line, else 80 MHz)")
+    parser.add_argument("--tick-us", type=float, default=1000.0)
+    args = parser.parse_args()
+
+    tasks = parse_config(args.config)
+    parse_wcet(args.wcet, tasks)
+    costs = parse_bench(args.bench, args.cpu_hz) if args.bench else None
+    known = analyse(tasks, args.tick_us, costs)
+    return 0 if report(tasks, known, args.tick_us, costs or {"tick": 0.0, "svc": 0.0, "switch": 0.0}) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
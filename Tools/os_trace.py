@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""
+Decode an OS_Trace recording (Includes/OS_Trace.h) into Chrome trace JSON, viewable in
+ui.perfetto.dev or chrome://tracing.
+
+Usage:
+  python3 Tools/os_trace.py trace.bin [-o trace.json] [--text]
+
+trace.bin is either an OS_Trace_Dump / debugger dump of OS_Trace (snapshot), or the bytes
+OS_Trace_Drain wrote (stream). Tasks become threads of one process, with their running time as
+slices; SVCs, ticks and interrupts get their own tracks. --text prints the events instead.
+
+Also usable as a library: read_trace() returns (header, events) with 64-bit timestamps.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x5254534F
+HEADER = struct.Struct("<IBBBBIIIII")
+EVENT = struct.Struct("<IBBH")
+NAME_LENGTH = 16
+NO_TASK = 0xFF
+
+SNAPSHOT, STREAM = 1, 2
+
+SWITCH, READY, TICK, SVC_ENTER, SVC_EXIT, SEM_TAKE, SEM_BLOCK, SEM_GIVE, ISR_ENTER, ISR_EXIT, USER = range(1, 12)
+EVENT_NAMES = {SWITCH: "switch", READY: "ready", TICK: "tick", SVC_ENTER: "svc", SVC_EXIT: "svc exit",
+               SEM_TAKE: "sem take", SEM_BLOCK: "sem block", SEM_GIVE: "sem give",
+               ISR_ENTER: "isr", ISR_EXIT: "isr exit", USER: "user"}
+
+# SVC numbers of OS_SVC_Service in Source/OS.c
+SVC_NAMES = {0: "ActivateTask", 1: "HoldTask", 2: "MutexLock", 3: "MutexUnlock",
+             4: "CountingSemaphoreTake", 5: "CountingSemaphoreGive", 6: "MessageQueueSend",
+             7: "MessageQueueReceive", 8: "MemPoolAlloc", 9: "MemPoolFree", 10: "EventGroupSet",
+             11: "EventGroupClear", 12: "EventGroupWait", 13: "SoftwareTimerStart",
+             14: "SoftwareTimerStop", 15: "SoftwareTimerReset", 16: "TimerTaskNext", 17: "TaskNotify",
+             18: "TaskNotify", 19: "TaskNotify", 20: "TaskNotifyWait",
+             21: "GetTimeUs", 22: "SemaphoreTake", 23: "SemaphoreGive",
+             24: "TickSync"}
+
+KERNEL_TID = 1000
+ISR_TID = 1001
+
+
+def read_trace(data):
+    """Header fields as a dict and the events in recording order as (cycles, type, task, arg)."""
+    if len(data) < HEADER.size:
+        raise ValueError("too short for a trace header")
+    magic, version, mode, event_size, tasks_no, capacity, head, tail, dropped, rate = HEADER.unpack_from(data)
+    if magic != MAGIC or event_size != EVENT.size:
+        raise ValueError("not an OS_Trace recording (magic %#x, event size %d)" % (magic, event_size))
+    offset = HEADER.size
+    names = []
+    for i in range(tasks_no):
+        raw = data[offset + i * NAME_LENGTH: offset + (i + 1) * NAME_LENGTH]
+        names.append(raw.split(b"\0", 1)[0].decode("ascii", "replace") or "task%d" % i)
+    offset += tasks_no * NAME_LENGTH
+    offset = (offset + 3) & ~3
+
+    slots = [EVENT.unpack_from(data, offset + i * EVENT.size) for i in range((len(data) - offset) // EVENT.size)]
+    if mode == SNAPSHOT:
+        slots = slots[:capacity]
+        if head > capacity:
+            start = head % capacity
+            slots = slots[start:] + slots[:start]
+        else:
+            slots = slots[:head]
+
+    events = []
+    wraps = 0
+    previous = None
+    for stamp, kind, task, arg in slots:
+        if kind == 0:
+            continue                     # Slot still being written when the ring was saved
+        if previous is not None and previous - stamp > 0x80000000:
+            wraps += 1
+        elif previous is not None and stamp - previous > 0x80000000:
+            wraps -= 1
+        previous = stamp
+        events.append((stamp + (wraps << 32), kind, task, arg))
+
+    header = {"version": version, "mode": mode, "tasks": names, "capacity": capacity,
+              "recorded": head, "dropped": dropped, "cycles_per_second": rate}
+    return header, events
+
+
+def task_name(header, task):
+    if task == NO_TASK or task >= len(header["tasks"]):
+        return "-"
+    return header["tasks"][task]
+
+
+def to_chrome(header, events):
+    us = 1e6 / header["cycles_per_second"]
+    origin = events[0][0] if events else 0
+    out = [{"ph": "M", "pid": 1, "name": "process_name", "args": {"name": "OS"}},
+           {"ph": "M", "pid": 1, "tid": KERNEL_TID, "name": "thread_name", "args": {"name": "kernel"}},
+           {"ph": "M", "pid": 1, "tid": ISR_TID, "name": "thread_name", "args": {"name": "interrupts"}}]
+    for i, name in enumerate(header["tasks"]):
+        out.append({"ph": "M", "pid": 1, "tid": i + 1, "name": "thread_name", "args": {"name": name}})
+        out.append({"ph": "M", "pid": 1, "tid": i + 1, "name": "thread_sort_index", "args": {"sort_index": i}})
+
+    running = None                       # (task, start)
+    for stamp, kind, task, arg in events:
+        ts = (stamp - origin) * us
+        if kind == SWITCH:
+            if running is not None:
+                out.append({"ph": "X", "pid": 1, "tid": running[0] + 1, "name": "running",
+                            "ts": running[1], "dur": ts - running[1]})
+            running = (task, ts)
+        elif kind == SVC_ENTER:
+            out.append({"ph": "B", "pid": 1, "tid": KERNEL_TID, "ts": ts, "name": SVC_NAMES.get(arg, "SVC %d" % arg),
+                        "args": {"caller": task_name(header, task)}})
+        elif kind == SVC_EXIT:
+            out.append({"ph": "E", "pid": 1, "tid": KERNEL_TID, "ts": ts})
+        elif kind == ISR_ENTER:
+            out.append({"ph": "B", "pid": 1, "tid": ISR_TID, "ts": ts, "name": "IRQ %d" % arg})
+        elif kind == ISR_EXIT:
+            out.append({"ph": "E", "pid": 1, "tid": ISR_TID, "ts": ts})
+        elif kind == TICK:
+            out.append({"ph": "i", "s": "t", "pid": 1, "tid": KERNEL_TID, "ts": ts, "name": "tick",
+                        "args": {"ticks": arg}})
+        elif task != NO_TASK:
+            out.append({"ph": "i", "s": "t", "pid": 1, "tid": task + 1, "ts": ts,
+                        "name": EVENT_NAMES.get(kind, "event %d" % kind), "args": {"arg": "%#06x" % arg}})
+    if running is not None and events:
+        end = (events[-1][0] - origin) * us
+        out.append({"ph": "X", "pid": 1, "tid": running[0] + 1, "name": "running", "ts": running[1], "dur": end - running[1]})
+
+    return {"traceEvents": out, "displayTimeUnit": "ns",
+            "metadata": {"recorded": header["recorded"], "dropped": header["dropped"]}}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("trace")
+    parser.add_argument("-o", "--output", help="JSON file, stdout when omitted")
+    parser.add_argument("--text", action="store_true", help="list the events instead of writing JSON")
+    args = parser.parse_args()
+
+    header, events = read_trace(open(args.trace, "rb").read())
+    if header["dropped"]:
+        print("warning: %d events dropped" % header["dropped"], file=sys.stderr)
+
+    if args.text:
+        origin = events[0][0] if events else 0
+        for stamp, kind, task, arg in events:
+            print("%12.3f us  %-10s %-16s %#06x" % ((stamp - origin) * 1e6 / header["cycles_per_second"],
+                                                     EVENT_NAMES.get(kind, kind), task_name(header, task), arg))
+        return 0
+
+    text = json.dumps(to_chrome(header, events))
+    if args.output:
+        open(args.output, "w").write(text)
+    else:
+        print(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -5,7 +5,7 @@
   
   OS_Init();
   
-  
+#if (OS_STATIC_TASKS == 0U)
   OS_CreateTask(Send_KeepAliveTask);
   OS_CreateTask(Receive_KeepAliveTask);
   
@@ -16,6 +16,7 @@
   OS_CreateTask(No_CommunicationTask);
   OS_CreateTask(OverheatTask);
   OS_CreateTask(SendToPCTask);
+#endif
  
   OS_Start();
   